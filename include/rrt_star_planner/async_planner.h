@@ -0,0 +1,71 @@
+#ifndef async_planner_h
+#define async_planner_h
+
+#include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <atomic>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Runs the planner on a background thread so makePlan does not block
+    * move_base. Each request only records the newest start and goal and
+    * returns the latest valid plan for that goal. A new goal cancels the
+    * running search through cancelled(), which the planning loops poll.
+    * While requests keep coming, the worker replans for the current goal at
+    * most once per replan period, from the newest start. A plan for an
+    * older goal is never returned, and a failed replan withdraws the plan.
+    * Anything the solver leaves beside the plan (e.g. statistics) is copied
+    * by the publish callback under the same lock, so readers that go through
+    * readPublished() see it consistent with the returned plan.
+    */
+	class AsyncPlanner {
+
+        public:
+
+            typedef boost::function<bool (const geometry_msgs::PoseStamped &, const geometry_msgs::PoseStamped &,
+                                          std::vector<geometry_msgs::PoseStamped> &)> SolveFunction;
+            typedef boost::function<void ()> PublishFunction;
+
+            AsyncPlanner();
+            ~AsyncPlanner();
+
+            void start(const SolveFunction &solve, const PublishFunction &publish, double replanPeriod, double idleTimeout);
+            void stop();
+            bool enabled() const { return running_; }
+            bool cancelled() const { return cancel_; }
+
+            bool request(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                         std::vector<geometry_msgs::PoseStamped> &plan, double waitTime);
+            void readPublished(const boost::function<void ()> &read);
+
+        private:
+            void run();
+            static bool sameGoal(const geometry_msgs::PoseStamped &a, const geometry_msgs::PoseStamped &b);
+
+            SolveFunction solve_;
+            PublishFunction publish_;
+            boost::thread thread_;
+            boost::mutex mutex_;
+            boost::condition_variable wake_;        // new request or shutdown, for the worker
+            boost::condition_variable planReady_;   // a plan for the current goal, for request()
+            bool running_;
+            std::atomic<bool> cancel_;
+            double replanPeriod_;
+            double idleTimeout_;
+
+            // guarded by mutex_
+            bool hasRequest_;
+            geometry_msgs::PoseStamped start_, goal_;
+            unsigned long goalGeneration_;          // bumped on every new goal
+            ros::WallTime lastRequest_;
+            bool hasResult_;                        // the current goal has been planned for at least once
+            bool hasPlan_;
+            std::vector<geometry_msgs::PoseStamped> plan_;
+	};
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef collision_checker_h
+#define collision_checker_h
+
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <rrt_star_planner/distance_field.h>
+#include <rrt_star_planner/footprint_masks.h>
+
+namespace rrtstar_planner {
+
+    /**
+    * Point and edge validity queries against the planner's CostmapSnapshot,
+    * never the live costmap. A cell is traversable when its blocked bit is
+    * clear, i.e. it is FREE_SPACE or NO_INFORMATION, matching the planner's
+    * original point test. Edges are checked by walking every cell the
+    * segment passes through, one row at a time, so that each row's cells
+    * form a contiguous run of bits that is tested a word at a time.
+    * When a DistanceField is attached, a cell is traversable when its
+    * clearance exceeds the configured minimum, and edges are checked by
+    * stepping through free space in jumps as long as the local clearance.
+    * With FootprintMasks attached the robot is no longer a point: only
+    * LETHAL_OBSTACLE cells block (the snapshot is taken in lethal-only
+    * mode), and a pose is checked by testing the row runs of the mask for
+    * its heading; an edge tests the mask of the edge direction at every
+    * cell the edge passes through. The distance field,
+    * if any, then only serves to accept cells farther from any obstacle
+    * than the circumscribed radius without looking at the mask.
+    */
+	class CollisionChecker {
+
+        public:
+
+            CollisionChecker();
+
+            void setSnapshot(const CostmapSnapshot* map);
+            void setDistanceField(const DistanceField* field, double minClearance);
+            void setFootprint(const FootprintMasks* masks);
+
+            bool pointFree(double X, double Y) const;
+            bool poseFree(double X, double Y, double theta) const;
+            bool segmentFree(double startX, double startY, double endX, double endY) const;
+
+        private:
+            friend struct FootprintRunTest;
+
+            bool segmentClearanceFree(double fx0, double fy0, double fx1, double fy1) const;
+            bool maskFree(int mask, int cx, int cy) const;
+            bool footprintCellFree(int heading, int cx, int cy) const;
+
+            const CostmapSnapshot* map_;
+            const DistanceField* field_;
+            double minClearance_;
+            const FootprintMasks* masks_;
+	};
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef costmap_snapshot_h
+#define costmap_snapshot_h
+
+#include <costmap_2d/costmap_2d.h>
+#include <stdint.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Planner-owned copy of the costmap, taken under the costmap's mutex at
+    * the start of each plan so that every later query sees one consistent
+    * map without holding the lock. Only one bit per cell is kept: whether
+    * the cell blocks the robot, i.e. anything but FREE_SPACE and
+    * NO_INFORMATION, or only LETHAL_OBSTACLE with footprint checks. Rows
+    * are padded to whole 64-byte cache lines and the grid is cache line
+    * aligned. The copy can be restricted to a region of interest; cells
+    * outside it are blocked and never read from the costmap, which keeps
+    * the lock short on large maps.
+    */
+	class CostmapSnapshot {
+
+        public:
+
+            CostmapSnapshot();
+
+            void setLethalOnly(bool lethalOnly);
+            bool update(costmap_2d::Costmap2D &costmap);
+            bool update(costmap_2d::Costmap2D &costmap, double minX, double minY, double maxX, double maxY);
+
+            unsigned int getSizeInCellsX() const { return sizeX_; }
+            unsigned int getSizeInCellsY() const { return sizeY_; }
+            double getResolution() const { return resolution_; }
+            double getOriginX() const { return originX_; }
+            double getOriginY() const { return originY_; }
+            double getSizeInMetersX() const { return (sizeX_ - 1 + 0.5) * resolution_; }
+            double getSizeInMetersY() const { return (sizeY_ - 1 + 0.5) * resolution_; }
+            bool worldToMap(double X, double Y, unsigned int &mx, unsigned int &my) const;
+
+            /** words of 64 cells per row, a multiple of 8 */
+            int stride() const { return stride_; }
+            const uint64_t* row(unsigned int my) const { return bits_ + my * stride_; }
+            bool blocked(unsigned int mx, unsigned int my) const { return (row(my)[mx >> 6] >> (mx & 63)) & 1; }
+            bool runFree(unsigned int my, int x0, int x1) const;
+
+        private:
+            bool packRow(const unsigned char* cells, uint64_t* out, int x0, int x1) const;
+
+            bool lethalOnly_;
+            unsigned int sizeX_, sizeY_;
+            double resolution_, originX_, originY_;
+            int stride_;
+            std::vector<uint64_t> storage_;
+            uint64_t* bits_;                        // first cache line aligned word of storage_
+	};
+};
+
+#endif
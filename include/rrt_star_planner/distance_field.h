@@ -0,0 +1,51 @@
+#ifndef distance_field_h
+#define distance_field_h
+
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <stdint.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Planner-owned Euclidean distance transform of the map snapshot.
+    * Every cell holds the distance (in cells, between cell centers) to the
+    * nearest blocked cell, clamped at a configurable maximum. A copy of the
+    * blocked bits from the previous update is kept so that update() only
+    * recomputes the area around cells that changed since then.
+    */
+	class DistanceField {
+
+        public:
+
+            DistanceField();
+
+            void setMaxDistance(double maxDistance);
+            bool update(const CostmapSnapshot &map);
+
+            float cellDistance(unsigned int mx, unsigned int my) const { return dist_[my * sizeX_ + mx]; }
+            const float* data() const { return dist_.data(); }
+            unsigned int getSizeInCellsX() const { return sizeX_; }
+            unsigned int getSizeInCellsY() const { return sizeY_; }
+            float maxCellDistance() const { return float(capCells_); }
+
+        private:
+            void recompute(int x0, int y0, int x1, int y1);
+            void transform1D(int n);
+
+            std::vector<uint64_t> lastBits_;
+            std::vector<float> dist_;
+            unsigned int sizeX_, sizeY_;
+            int stride_;                        // words per row of lastBits_
+            double resolution_, originX_, originY_;
+            double maxDistance_;
+            int capCells_;
+
+            // scratch buffers reused across updates
+            std::vector<double> window_;
+            std::vector<double> f_, d_, z_;
+            std::vector<int> v_;
+	};
+};
+
+#endif
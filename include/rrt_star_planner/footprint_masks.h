@@ -0,0 +1,57 @@
+#ifndef footprint_masks_h
+#define footprint_masks_h
+
+#include <geometry_msgs/Point.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * The robot footprint rasterized into cell masks for a fixed set of
+    * headings. Each mask is a list of row runs relative to the cell holding
+    * the robot center and covers every cell the footprint can touch while
+    * the center is anywhere in that cell and the heading is anywhere in the
+    * mask's heading bin, so testing the mask is conservative. One more mask
+    * holds the cells covered by the inscribed circle at every such position,
+    * for heading-independent rejection. The masks are only rebuilt when the
+    * footprint or the resolution changes.
+    */
+	class FootprintMasks {
+
+        public:
+
+            struct Run
+            {
+                int dy, dx0, dx1;
+            };
+
+            FootprintMasks();
+
+            void setHeadings(int headings);
+            bool update(const std::vector<geometry_msgs::Point> &footprint, double resolution);
+
+            bool empty() const { return footprint_.size() < 3; }
+            int headings() const { return headings_; }
+            int headingIndex(double theta) const;
+            double circumscribedRadius() const { return circumscribed_; }
+
+            /** runs of the mask for the given heading index, headings() for the inscribed circle */
+            const Run* begin(int mask) const { return &runs_[start_[mask]]; }
+            const Run* end(int mask) const { return &runs_[0] + start_[mask + 1]; }
+
+        private:
+            void rasterize(double theta, double margin);
+            void rasterizeInscribed();
+
+            int headings_;
+            double resolution_;
+            std::vector<geometry_msgs::Point> footprint_;
+            double circumscribed_, inscribed_;
+
+            std::vector<Run> runs_;
+            std::vector<int> start_;                // first run of each mask
+            std::vector<double> polyX_, polyY_;     // rotated footprint, scratch
+	};
+};
+
+#endif
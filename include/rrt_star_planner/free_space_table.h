@@ -0,0 +1,72 @@
+#ifndef free_space_table_h
+#define free_space_table_h
+
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <rrt_star_planner/collision_checker.h>
+#include <rrt_star_planner/reachability_map.h>
+#include <stdint.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Compact list of the traversable costmap cells, so that samples can be
+    * drawn from free space only instead of the whole map rectangle. A point
+    * of the unit square is mapped to a cell by its first coordinate and
+    * jittered inside that cell by what is left of the first and by the
+    * second, so a low discrepancy sequence stays evenly spread over the
+    * free cells. When a ReachabilityMap is given the cells are grouped by
+    * component and sampling can be restricted to the component of the start.
+    * Whether the collision checker accepts each cell is kept as a bit per
+    * cell. When the map snapshot changes, only the cells within the margin
+    * of the changed cells are tested again, and the list is regenerated
+    * from the bits by scanning words. The margin is the distance up to which
+    * a blocked cell can make the checker reject a point, i.e. the clearance
+    * plus the circumscribed radius of the footprint.
+    */
+	class FreeSpaceTable {
+
+        public:
+
+            FreeSpaceTable();
+
+            bool update(const CostmapSnapshot &map, const CollisionChecker &checker,
+                        const ReachabilityMap* components);
+            void restrictTo(int component);
+            void setMargin(double margin) { margin_ = margin; }
+            void invalidate() { lastBits_.clear(); }
+
+            bool empty() const { return begin_ == end_; }
+            int size() const { return end_ - begin_; }
+
+            void sample(double u, double v, double &X, double &Y) const
+            {
+                double k = u * (end_ - begin_);
+                int i = int(k);
+                uint32_t cell = cells_[begin_ + i];
+                X = originX_ + (cell % sizeX_ + (k - i)) * resolution_;
+                Y = originY_ + (cell / sizeX_ + v) * resolution_;
+            }
+
+        private:
+            void testCells(const CollisionChecker &checker, unsigned int y, int x0, int x1);
+
+            std::vector<uint64_t> lastBits_;
+            unsigned int sizeX_, sizeY_;
+            int stride_;
+            double resolution_, originX_, originY_;
+            double margin_;
+            std::vector<uint64_t> freeBits_;        // cells the checker accepts, same layout as the snapshot
+
+            std::vector<uint32_t> cells_;           // free cell indices, grouped by component
+            std::vector<int> groupStart_;           // first cell of each component, the first group has no component
+            int begin_, end_;                       // cells that are sampled from
+
+            // scratch buffers reused across updates
+            std::vector<uint32_t> free_;
+            std::vector<int> group_;
+            std::vector<int> spanX0_, spanX1_;      // per row, the cells to test again
+	};
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef node_grid_h
+#define node_grid_h
+
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Uniform bucket grid over the costmap bounds used to answer nearest and
+    * near-neighbor queries on the RRT tree without scanning every node.
+    * Buckets are singly linked lists threaded through per-node arrays, so
+    * inserting a node never allocates once the arrays have grown. The grid
+    * does not keep coordinates itself; queries read them from the node
+    * store's position arrays.
+    * Nodes that fall outside the configured bounds are kept in a small
+    * overflow list that is always scanned.
+    * One writer may insert nodes inside the bounds while other threads query:
+    * a node is linked in before the bucket head is published (release), and
+    * queries follow the heads with acquire loads, so they see every node
+    * whose coordinates were written before its insert. Moving, removing and
+    * overflow inserts still need exclusive access.
+    */
+	class NodeGrid {
+
+        public:
+
+            NodeGrid();
+
+            void configure(double originX, double originY, double sizeX, double sizeY, double cellSize);
+            void clear();
+            void reserve(int capacity);
+            int capacity() const;
+
+            void insert(int nodeID, double X, double Y);
+            void move(int nodeID, double X, double Y);
+            void remove(int nodeID);
+
+            int nearest(double X, double Y, const double *posX, const double *posY) const;
+            void radius(double X, double Y, double r, const double *posX, const double *posY,
+                        std::vector<int> &result) const;
+            void nearestK(double X, double Y, int k, const double *posX, const double *posY,
+                          std::vector<int> &result) const;
+
+            int size() const;
+
+        private:
+            int head(int cell) const { return __atomic_load_n(&head_[cell], __ATOMIC_ACQUIRE); }
+            static int load(const int &value) { return __atomic_load_n(&value, __ATOMIC_RELAXED); }
+            static void store(int &value, int v) { __atomic_store_n(&value, v, __ATOMIC_RELAXED); }
+            int cellOf(double X, double Y) const;
+            void unlink(int nodeID);
+            void scanCell(int cell, double X, double Y, const double *posX, const double *posY,
+                          double &bestDist, int &bestID) const;
+
+            double originX_, originY_;
+            double cellSize_;
+            int cellsX_, cellsY_;
+
+            std::vector<int> head_;     // first node in each cell, -1 if empty
+            std::vector<int> next_;     // next node in the same cell
+            std::vector<int> cell_;     // cell a node is linked into, -1 for overflow, -2 if absent
+            std::vector<int> overflow_;
+            int limit_;                 // ids below this have been inserted at least once, published with cell_
+            int count_;
+            int minCellX_, minCellY_, maxCellX_, maxCellY_;   // bounding box of buckets ever filled since clear()
+	};
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef node_store_h
+#define node_store_h
+
+#include <rrt_star_planner/node_grid.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Structure-of-arrays storage for the RRT tree. The node id is the index
+    * into every array. Children are kept as linked offsets (first child and
+    * next/previous sibling per node), so re-parenting a node is O(1) and
+    * never allocates. The store owns the NodeGrid spatial index and keeps it
+    * in sync with every position change.
+    * Within the reserved capacity the store is append-only for concurrent
+    * readers: one writer at a time may add nodes, re-parent them and update
+    * costs while other threads run the spatial queries and read positions
+    * and costs. A node is published through the index and size() only after
+    * its position, parent and cost are written; costs are read and written
+    * atomically. Everything else needs exclusive access.
+    */
+	class NodeStore {
+
+        public:
+
+            NodeStore();
+
+            int add(double X, double Y, int parentID, double cost);
+            void popBack();
+            void erase(int nodeID);
+            int prune(std::vector<int> &newID);
+            void clear();
+            void reserve(int capacity);
+            int size() const { return __atomic_load_n(&size_, __ATOMIC_ACQUIRE); }
+            int capacity() const;
+
+            void configureIndex(double originX, double originY, double sizeX, double sizeY, double cellSize);
+            int nearest(double X, double Y) const;
+            void radius(double X, double Y, double r, std::vector<int> &result) const;
+            void nearestK(double X, double Y, int k, std::vector<int> &result) const;
+
+            double x(int nodeID) const { return posX_[nodeID]; }
+            double y(int nodeID) const { return posY_[nodeID]; }
+            double cost(int nodeID) const { double c; __atomic_load(&cost_[nodeID], &c, __ATOMIC_RELAXED); return c; }
+            int parent(int nodeID) const { return parent_[nodeID]; }
+            int firstChild(int nodeID) const { return firstChild_[nodeID]; }
+            int nextSibling(int nodeID) const { return nextSibling_[nodeID]; }
+            int childCount(int nodeID) const { return childCount_[nodeID]; }
+
+            const std::vector<double> &posX() const { return posX_; }
+            const std::vector<double> &posY() const { return posY_; }
+            const std::vector<double> &cost() const { return cost_; }
+            const std::vector<int> &parent() const { return parent_; }
+
+            void setPos(int nodeID, double X, double Y);
+            void setCost(int nodeID, double cost) { __atomic_store(&cost_[nodeID], &cost, __ATOMIC_RELAXED); }
+            void setParent(int nodeID, int parentID);
+            int updateSubtreeCost(int nodeID);
+
+        private:
+            void linkChild(int nodeID);
+            void unlinkChild(int nodeID);
+            void rebuildLinks();
+            void setSize(int size) { __atomic_store_n(&size_, size, __ATOMIC_RELEASE); }
+
+            std::vector<double> posX_;
+            std::vector<double> posY_;
+            std::vector<double> cost_;
+            std::vector<int> parent_;       // the root is its own parent
+            std::vector<int> firstChild_;
+            std::vector<int> nextSibling_;
+            std::vector<int> prevSibling_;
+            std::vector<int> childCount_;
+            NodeGrid grid_;
+            int size_;                      // number of nodes, published after the node is complete
+	};
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef path_smoother_h
+#define path_smoother_h
+
+#include <rrt_star_planner/collision_checker.h>
+#include <rrt_star_planner/sampler.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Post-processing of the tree path before it becomes the plan.
+    * The path is shortened by a greedy pass that connects every waypoint to
+    * the farthest following one it can reach in a straight line, then by
+    * random shortcuts between points on two segments. Waypoints that lie on
+    * the line between their neighbours are dropped, and the result can be
+    * resampled at a fixed spacing. Every new edge is collision checked, so
+    * the smoothed path is valid wherever the tree path was.
+    * The waypoints are kept as separate X and Y arrays. Every step writes
+    * into outX_/outY_ and swaps them with the caller's arrays, so the two
+    * pairs trade storage back and forth. configure() reserves them to the
+    * capacity the caller reserved for its own arrays; paths up to that many
+    * waypoints are then smoothed without allocating.
+    */
+	class PathSmoother {
+
+        public:
+
+            PathSmoother();
+
+            void setCollisionChecker(const CollisionChecker* checker) { checker_ = checker; }
+            void configure(int shortcutIterations, double collinearTolerance, double resolution, int capacity);
+
+            void smooth(std::vector<double> &pathX, std::vector<double> &pathY, Sampler &sampler);
+
+            static double length(const std::vector<double> &pathX, const std::vector<double> &pathY);
+
+        private:
+            void shortcutGreedy(std::vector<double> &pathX, std::vector<double> &pathY);
+            void shortcutRandom(std::vector<double> &pathX, std::vector<double> &pathY, Sampler &sampler);
+            void removeCollinear(std::vector<double> &pathX, std::vector<double> &pathY);
+            void resample(std::vector<double> &pathX, std::vector<double> &pathY);
+            bool edgeFree(double startX, double startY, double endX, double endY) const;
+
+            const CollisionChecker* checker_;
+            int shortcutIterations_;
+            double collinearTolerance_;
+            double resolution_;
+            std::vector<double> outX_, outY_;
+            std::vector<double> arcLength_;
+	};
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef plan_profiler_h
+#define plan_profiler_h
+
+#include <stdint.h>
+#include <time.h>
+
+namespace rrtstar_planner {
+
+    /**
+    * Per-plan time spent in each phase of the planner loop and event counters.
+    * Phase times are exclusive: a timer opened inside another phase (e.g. a
+    * collision check during choose-parent) stops the clock of the outer phase
+    * until it is closed, so the phases add up to the total planning time.
+    * Instrumentation goes through the RRT_PROFILE_* macros, which compile to
+    * nothing unless RRT_STAR_PROFILING is defined.
+    */
+	class PlanProfiler {
+
+        public:
+
+            enum Phase { OTHER = 0, SAMPLING, NEAREST, COLLISION, CHOOSE_PARENT, REWIRE, VISUALIZATION, REPAIR, SNAPSHOT, ROADMAP, PHASE_COUNT };
+            enum Counter { SAMPLES_DRAWN = 0, SAMPLES_REJECTED, COLLISION_CHECKS, REWIRES, NODES_ADDED,
+                           EDGES_INVALIDATED, NODES_RECONNECTED, NODES_DROPPED, COUNTER_COUNT };
+
+            PlanProfiler() { reset(); }
+
+            void reset();
+            void finish();
+            void discard() { mark_ = now(); }
+            void merge(const PlanProfiler &other);
+
+            void count(Counter counter, long n = 1) { counters_[counter] += n; }
+            double phaseTime(Phase phase) const { return phaseNs_[phase] * 1e-9; }
+            long counter(Counter counter) const { return counters_[counter]; }
+
+            static const char *phaseName(Phase phase);
+            static const char *counterName(Counter counter);
+
+            static uint64_t now()
+            {
+                timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+            }
+
+            class ScopedTimer {
+                public:
+                    ScopedTimer(PlanProfiler &profiler, Phase phase)
+                        : profiler_(profiler), outer_(profiler.enter(phase)) {}
+                    ~ScopedTimer() { profiler_.enter(outer_); }
+                private:
+                    ScopedTimer(const ScopedTimer&);
+                    ScopedTimer &operator=(const ScopedTimer&);
+                    PlanProfiler &profiler_;
+                    Phase outer_;
+            };
+
+        private:
+            Phase enter(Phase phase)
+            {
+                uint64_t t = now();
+                phaseNs_[current_] += t - mark_;
+                mark_ = t;
+                Phase outer = current_;
+                current_ = phase;
+                return outer;
+            }
+
+            uint64_t phaseNs_[PHASE_COUNT];
+            long counters_[COUNTER_COUNT];
+            Phase current_;
+            uint64_t mark_;
+	};
+};
+
+#define RRT_PROFILE_CONCAT_(a, b) a##b
+#define RRT_PROFILE_CONCAT(a, b) RRT_PROFILE_CONCAT_(a, b)
+
+#ifdef RRT_STAR_PROFILING
+#define RRT_PROFILE_SCOPE(profiler, phase) \
+    rrtstar_planner::PlanProfiler::ScopedTimer RRT_PROFILE_CONCAT(profileScope_, __LINE__)((profiler), rrtstar_planner::PlanProfiler::phase)
+#define RRT_PROFILE_COUNT(profiler, counter) (profiler).count(rrtstar_planner::PlanProfiler::counter)
+#define RRT_PROFILE_ADD(profiler, counter, n) (profiler).count(rrtstar_planner::PlanProfiler::counter, (n))
+#else
+// the arguments are still named so that a profiler or count passed in only for profiling is not an unused variable;
+// the count is not evaluated
+#define RRT_PROFILE_SCOPE(profiler, phase) ((void)(profiler))
+#define RRT_PROFILE_COUNT(profiler, counter) ((void)(profiler))
+#define RRT_PROFILE_ADD(profiler, counter, n) ((void)(profiler), (void)sizeof(n))
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef reachability_map_h
+#define reachability_map_h
+
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Connected components of free space on a downsampled copy of the map
+    * snapshot, used to reject unreachable goals before planning. A coarse
+    * cell is free if any of the cells it covers is not blocked, and coarse
+    * cells are 8-connected, so two points in different components can never
+    * be joined by the planner; the converse does not hold. The labels are
+    * kept between calls and only recomputed when the coarse free mask changes.
+    */
+	class ReachabilityMap {
+
+        public:
+
+            ReachabilityMap();
+
+            void setDownsample(int factor);
+            bool update(const CostmapSnapshot &map);
+
+            int component(double X, double Y) const;
+            bool connected(double startX, double startY, double goalX, double goalY) const;
+
+        private:
+            void label();
+
+            int factor_;
+            unsigned int sizeX_, sizeY_;            // costmap size the mask was built for
+            int cellsX_, cellsY_;                   // coarse grid size
+            double originX_, originY_, cellSize_;
+            std::vector<unsigned char> free_;
+            std::vector<unsigned char> mask_;       // scratch for the next free mask
+            std::vector<int> label_;                // component of each coarse cell, -1 if blocked
+            std::vector<int> queue_;
+	};
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef roadmap_h
+#define roadmap_h
+
+#include <rrt_star_planner/node_store.h>
+#include <rrt_star_planner/collision_checker.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Persistent roadmap over free space for answering many start/goal
+    * queries on the same map. Nodes live in a NodeStore, which is used only
+    * for positions and its spatial index. Every node is joined to up to
+    * maxDegree of its nearest neighbors within the connection radius by
+    * collision-free straight edges, kept as linked adjacency entries. A query
+    * point is never inserted. It is linked to nearby nodes as a Terminal,
+    * and Dijkstra runs from the start terminal until every goal terminal is
+    * settled. That way one search yields a whole row of a cost matrix. The
+    * roadmap is only valid for the map it was grown on; the owner clears it
+    * when the map changes.
+    */
+	class Roadmap {
+
+        public:
+
+            /** a query point and the roadmap nodes it reaches by free edges */
+            struct Terminal
+            {
+                double x, y;
+                std::vector<int> nodes;
+                std::vector<double> lengths;
+            };
+
+            Roadmap();
+
+            void configure(double radius, int maxDegree);
+            void setBounds(double originX, double originY, double sizeX, double sizeY);
+            void clear();
+            void reserve(int capacity);
+            int size() const { return nodes_.size(); }
+            int edges() const { return edgeTo_.size() / 2; }
+            double x(int node) const { return nodes_.x(node); }
+            double y(int node) const { return nodes_.y(node); }
+
+            int addNode(double X, double Y, const CollisionChecker &checker);
+            bool connect(double X, double Y, const CollisionChecker &checker, Terminal &terminal);
+            void costs(const Terminal &start, const std::vector<Terminal> &goals, const CollisionChecker &checker,
+                       std::vector<double> &result);
+            double path(const Terminal &start, const Terminal &goal, const CollisionChecker &checker,
+                        std::vector<int> &nodes);
+
+        private:
+            struct Entry
+            {
+                double cost;
+                int node;
+                bool operator<(const Entry &other) const { return cost > other.cost; }
+            };
+
+            void addEdge(int a, int b, double length);
+            void nearestCandidates(double X, double Y, int excludeID);
+            void search(const Terminal &start, const Terminal *goals, int count, const CollisionChecker &checker);
+
+            double radius_;
+            int maxDegree_;
+            NodeStore nodes_;
+
+            // adjacency: edges leaving each node, as linked entries; every edge is stored once per direction
+            std::vector<int> edgeHead_;
+            std::vector<int> edgeTo_, edgeNext_;
+            std::vector<double> edgeLength_;
+
+            // search state, valid for nodes whose visit_ equals generation_
+            std::vector<unsigned int> visit_;
+            unsigned int generation_;
+            std::vector<double> dist_;
+            std::vector<int> prev_;
+            std::vector<Entry> heap_;
+
+            // goal links of the running search, by roadmap node
+            std::vector<int> goalHead_;
+            std::vector<int> goalIndex_, goalNext_;
+            std::vector<double> goalLength_;
+            std::vector<double> goalCost_;
+            std::vector<int> goalVia_;              // last roadmap node before each goal, -1 for the direct edge
+
+            // scratch buffers reused across calls
+            std::vector<int> candidates_;
+	};
+};
+
+#endif
@@ -9,7 +9,24 @@
 #include <angles/angles.h>
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/costmap_model.h>
+#include <rrt_star_planner/node_store.h>
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <rrt_star_planner/collision_checker.h>
+#include <rrt_star_planner/tree_visualizer.h>
+#include <rrt_star_planner/sampler.h>
+#include <rrt_star_planner/plan_profiler.h>
+#include <rrt_star_planner/path_smoother.h>
+#include <rrt_star_planner/reachability_map.h>
+#include <rrt_star_planner/free_space_table.h>
+#include <rrt_star_planner/async_planner.h>
+#include <rrt_star_planner/tree_repair.h>
+#include <rrt_star_planner/roadmap.h>
+#include <rrt_star_planner/tree_snapshot.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/function.hpp>
 #include <vector>
+#include <map>
+#include <string>
 
 using std::string;
 using namespace std;
@@ -20,6 +37,7 @@ namespace rrtstar_planner {
 
             RRT();
             RRT(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+            RRT(std::string name, costmap_2d::Costmap2D* costmap, std::string global_frame);
             RRT(double input_PosX, double input_PosY);
 
             struct rrtNode{
@@ -32,8 +50,31 @@ namespace rrtstar_planner {
                 vector<int> children;
             };
 
+            /** summary of the last makePlan call */
+            struct PlanStatistics{
+                enum FailureReason { NONE, INVALID_START, INVALID_GOAL, UNREACHABLE, ITERATION_LIMIT, TIME_LIMIT, INTERRUPTED };
+
+                bool pathFound;
+                FailureReason failureReason;
+                int iterations;
+                int nodes;
+                double planningTime;        // seconds
+                double firstSolutionTime;   // seconds from the start of makePlan, -1 if none was found
+                double pathCost;            // length of the returned plan in meters
+                double rawPathCost;         // length of the tree path before smoothing
+                uint64_t seed;              // random seed the plan was drawn with
+                PlanProfiler profile;       // per-phase times (summed over threads) and counters, all zero without RRT_STAR_PROFILING
+
+                static const char *failureReasonName(FailureReason reason);
+
+                PlanStatistics()
+                    : pathFound(false), failureReason(NONE), iterations(0), nodes(0), planningTime(0), firstSolutionTime(-1), pathCost(0), rawPathCost(0), seed(0) {}
+            };
+
             vector<rrtNode> getTree();
             vector<rrtNode> getNearestNeighbor(int tempNodeID);//这一行是新加的
+            void getNearestNeighbor(int tempNodeID, vector<rrtNode> &rrtNeighbor);
+            const vector<int> &getNearestNeighborIDs(int tempNodeID);
             void setTree(vector<rrtNode> input_rrtTree);
             int getTreeSize();
 
@@ -41,6 +82,7 @@ namespace rrtstar_planner {
             void deleteNewNode();
             rrtNode removeNode(int nodeID);
             rrtNode getNode(int nodeID);
+            void getNode(int nodeID, rrtNode &node);
 
             double getPosX(int nodeID);
             double getPosY(int nodeID);
@@ -56,6 +98,7 @@ namespace rrtstar_planner {
 
             int getNearestNodeID(double X, double Y);
             vector<int> getRootToEndPath(int endNodeID);
+            void getRootToEndPath(int endNodeID, vector<int> &path);
 
             bool judgeangle1(RRT myRRT, rrtNode tempNode);
             //bool judgeangle2(rrtNode rrtNeighbor,int NeighborParent,int NeighborID,rrtNode tempNode,int tempNodeID);
@@ -70,32 +113,163 @@ namespace rrtstar_planner {
             
             void initNode(RRT::rrtNode &newNode, const geometry_msgs::PoseStamped& start);
 
-            void generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,costmap_2d::Costmap2D* costmap_);
-            bool judgeangle1(RRT::rrtNode tempNode);
+            void generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,const CostmapSnapshot &map);
+            void generateInformedPoint(RRT::rrtNode &tempNode, double startX, double startY,
+                                       double goalX, double goalY, double bestCost);
+            bool judgeangle1(const RRT::rrtNode &tempNode);
             bool addNewPointtoRRT(RRT::rrtNode &tempNode, double rrtStepSize);
             bool checkIfInsideBoundary(RRT::rrtNode &tempNode);
+            bool checkIfInsideBoundary(double X, double Y);
             bool checkIfOutsideObstacles(RRT::rrtNode tempNode);
+            bool checkIfOutsideObstacles(double X, double Y);
+            bool checkIfEdgeOutsideObstacles(double startX, double startY, double endX, double endY);
+            bool checkIfEdgeOutsideObstacles(PlanProfiler &profiler, double startX, double startY, double endX, double endY);
             void addBranchtoRRTTree(visualization_msgs::Marker &rrtTreeMarker, RRT::rrtNode &tempNode);
             bool checkNodetoGoal(double X, double Y, RRT::rrtNode &tempNode);
             void setFinalPathData(vector< vector<int> > &rrtPaths,  int i, visualization_msgs::Marker &finalpath, double goalX, double goalY);
+            void getPlanFromPath(const vector<int> &path, const geometry_msgs::PoseStamped& start,
+                const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan);
 
 
             void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+            void initialize(std::string name, costmap_2d::Costmap2D* costmap, std::string global_frame);
+            void setParameter(const std::string &name, const std::string &value);
+            PlanStatistics getPlanStatistics();
+
+            /** called with true right before the single-threaded planning loop and with false as it exits, before the path is extracted */
+            typedef boost::function<void (bool)> LoopHook;
+            void setLoopHook(const LoopHook &hook) { loopHook_ = hook; }
             bool makePlan(const geometry_msgs::PoseStamped& start,
                 const geometry_msgs::PoseStamped& goal,
                 std::vector<geometry_msgs::PoseStamped>& plan
                );
+            bool makeCostMatrix(const std::vector<geometry_msgs::PoseStamped> &starts,
+                                const std::vector<geometry_msgs::PoseStamped> &goals,
+                                std::vector< std::vector<double> > &costs);
+            bool saveTree(const std::string &path) const;
+            bool loadTree(const std::string &path);
             
-            vector<rrtNode> rrtTree;
-            ros::NodeHandle pn;
+            NodeStore rrtTree;
 
         private:
             double getEuclideanDistance(double sourceX, double sourceY, double destinationX, double destinationY);
+            template <class T>
+            void loadParam(const ros::NodeHandle *nh, const std::string &name, T &value, const T &defaultValue);
+            bool planSync(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                          std::vector<geometry_msgs::PoseStamped>& plan);
+            bool keepPlanning() const;
+            bool solve(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                       std::vector<geometry_msgs::PoseStamped>& plan);
+            bool updateMap(double minX, double minY, double maxX, double maxY);
+            void prepareRoadmap(const ros::WallTime &deadline);
+            int growRoadmap(int count, const ros::WallTime &deadline);
+            bool solveRoadmap(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                              std::vector<geometry_msgs::PoseStamped>& plan);
+            void markSolutionFound();
+            bool checkQuery(double startX, double startY, double goalX, double goalY);
+            PlanStatistics::FailureReason checkBudget(int iterations) const;
+            bool fail(PlanStatistics::FailureReason reason);
+            void publishDiagnostics();
+
+            struct ParallelContext;
+            int growTreeParallel(double goalX, double goalY, double rrtStepSize, ros::WallTime planStart, uint64_t seed);
+            void parallelWorker(ParallelContext *ctx, unsigned int stream);
+            bool reRootTree(double startX, double startY, double goalX, double goalY, bool checkEdges);
+            void publishFinalPath(const visualization_msgs::Marker &finalPath);
+            void rewireNode(int nodeID, int parentID);
+            void rewireNode(NodeStore &tree, int nodeID, int parentID);
+            void findNeighbors(double X, double Y, int excludeID, vector<int> &result);
+            void findNeighbors(const NodeStore &tree, double X, double Y, int excludeID, vector<int> &result);
+            void buildPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                           std::vector<geometry_msgs::PoseStamped>& plan);
+
+            bool solveBidirectional(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                                    std::vector<geometry_msgs::PoseStamped>& plan, visualization_msgs::Marker &finalPath);
+            int extendTree(NodeStore &tree, double targetX, double targetY, double stepSize);
+            int connectTree(NodeStore &tree, double targetX, double targetY, double stepSize);
+            int updateBestConnection();
+            void addGoalNode(int nodeID, double goalX, double goalY);
+            void updateBestGoal(double goalX, double goalY);
             bool initialized_;
+            std::string name_;
+            std::map<std::string, std::string> paramOverrides_;
+            std::string globalFrame_;
+            PlanStatistics stats_;
+            LoopHook loopHook_;
+            bool publishDiagnostics_;
+            ros::Publisher diagnosticsPub_;
+            ros::WallTime planStart_;
             costmap_2d::Costmap2DROS* costmap_ros_;
             costmap_2d::Costmap2D* costmap_;
+            CostmapSnapshot snapshot_;          // copy of costmap_ taken at the start of each plan, read by every check
+            double snapshotMargin_;             // 0 copies the whole map, else the start/goal box grown by this much
             base_local_planner::WorldModel* world_model_;
             std::vector<geometry_msgs::Point> footprint;
+            CollisionChecker collisionChecker_;
+            bool footprintChecking_;
+            FootprintMasks footprintMasks_;
+            DistanceField distanceField_;
+            bool useDistanceField_;
+
+            bool anytime_;
+            double maxPlanningTime_;
+            int maxIterations_;
+            bool informedSampling_;
+            int plannerThreads_;
+            bool reuseTree_;
+            bool dynamicReplanning_;
+            TreeRepair treeRepair_;
+            double clearance_;                  // min_clearance when the distance field is used, else 0
+            bool reachabilityCheck_;
+            ReachabilityMap reachability_;
+            bool freeSpaceSampling_;
+            FreeSpaceTable freeSpace_;
+            double lastGoalX_, lastGoalY_;
+            std::string treeSnapshotFile_;
+            bool saveTreeSnapshot_;
+            bool treeLoaded_;                   // rrtTree came from a snapshot file and has not been planned with yet
+            Sampler sampler_;
+            Sampler::Sequence sampleSequence_;
+            int randomSeed_;
+            bool visualize_;
+            TreeVisualizer visualizer_;
+            int bestGoalNodeID_;
+            double bestGoalCost_;
+            vector<int> goalNodeIDs_;
+            vector<int> neighborIDs_;
+            vector<int> pathBuffer_;
+
+            //双向模式：第二棵树从目标点生长，connections_记录两棵树在同一点相接的节点对
+            bool bidirectional_;
+            NodeStore goalTree_;
+            vector< std::pair<int, int> > connections_;
+
+            bool smoothPath_;
+            PathSmoother pathSmoother_;
+            vector<double> planX_, planY_;
+
+            //多查询模式：在整张地图上持久保存一张路图，起点和终点只需连接到路图上再做图搜索
+            bool multiQuery_;
+            Roadmap roadmap_;
+            Sampler roadmapSampler_;
+            int roadmapNodes_, roadmapMaxNodes_;
+            Roadmap::Terminal startTerminal_;
+            vector<Roadmap::Terminal> goalTerminals_;
+            vector<int> roadmapPath_;
+            boost::mutex planMutex_;            // plans and cost matrices share the snapshot and the roadmap
+
+            enum NeighborPolicy { FIXED_RADIUS, SHRINKING_RADIUS, KNEAREST_NEIGHBORS };
+            NeighborPolicy neighborPolicy_;
+            double rrtStepSize_;
+            double neighborRadius_;
+            double rrtGammaParam_, rrtGamma_;
+            double kRRT_;
+            int maxNeighbors_;
+
+            //后台规划线程最后析构，先于它使用的其他成员停止
+            double asyncWaitTime_;
+            PlanStatistics publishedStats_;         // stats_ of the plan last published by asyncPlanner_, guarded by its lock
+            AsyncPlanner asyncPlanner_;
 	};
 };
 
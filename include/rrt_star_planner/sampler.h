@@ -0,0 +1,57 @@
+#ifndef sampler_h
+#define sampler_h
+
+#include <stdint.h>
+
+namespace rrtstar_planner {
+
+    /**
+    * Random source for the planner, one instance per thread.
+    * Numbers come from xoshiro256+; seed(seed, stream) gives every stream a
+    * non-overlapping part of the same sequence, so a fixed seed replays the
+    * same samples. Free-space samples can instead come from a randomly
+    * shifted Halton sequence (bases 2 and 3), which covers the map more
+    * evenly. Values are generated in batches and handed out from a buffer.
+    */
+	class Sampler {
+
+        public:
+
+            enum Sequence { UNIFORM, HALTON };
+
+            Sampler();
+
+            void seed(uint64_t seed, unsigned int stream = 0);
+            void setSequence(Sequence sequence);
+
+            /** uniform number in [0, 1) */
+            double uniform()
+            {
+                if(next_ == BATCH)
+                    refill();
+                return batch_[next_++];
+            }
+
+            void point(double &u, double &v);
+
+        private:
+            static const int BATCH = 128;
+
+            uint64_t nextRaw();
+            void jump();
+            void refill();
+            void refillPoints();
+
+            uint64_t state_[4];
+            double batch_[BATCH];
+            int next_;
+
+            Sequence sequence_;
+            double points_[BATCH];
+            int nextPoint_;
+            uint32_t haltonIndex_;
+            double shiftU_, shiftV_;
+	};
+};
+
+#endif
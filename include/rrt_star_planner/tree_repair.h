@@ -0,0 +1,77 @@
+#ifndef tree_repair_h
+#define tree_repair_h
+
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <rrt_star_planner/node_store.h>
+#include <rrt_star_planner/collision_checker.h>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Incremental repair of a kept RRT tree after costmap updates, in the
+    * spirit of RRTX. update() compares the map snapshot with the copy from
+    * the previous call and marks the coarse buckets around changed cells dirty,
+    * grown by a margin for clearance and footprint. repair() indexes every
+    * tree edge by the buckets its bounding box covers and re-checks only
+    * the edges listed in dirty buckets. Blocked edges are cut, which orphans
+    * their subtrees. Orphans are then reconnected cheapest first, Dijkstra
+    * style: first through free edges to neighbors still in the tree, then
+    * through their old child edges or free edges to other reconnected
+    * orphans. Costs are set along the way. Orphans that cannot be reached
+    * are dropped and the tree is renumbered.
+    */
+	class TreeRepair {
+
+        public:
+
+            enum MapChange { UNCHANGED, CHANGED, RESET };
+
+            TreeRepair();
+
+            void setMargin(double margin);
+            MapChange update(const CostmapSnapshot &map);
+            int repair(NodeStore &tree, const CollisionChecker &checker, double radius);
+
+            int invalidatedEdges() const { return invalidated_; }
+            int reconnectedNodes() const { return reconnected_; }
+
+        private:
+            struct Candidate
+            {
+                double cost;
+                int node, parent;
+                bool operator<(const Candidate &other) const { return cost > other.cost; }
+            };
+
+            void markDirty(int x0, int x1, int y);
+            int bucketOf(double X, double Y, int &bx, int &by) const;
+            void indexEdges(const NodeStore &tree);
+            void push(double cost, int node, int parent);
+
+            std::vector<uint64_t> lastBits_;
+            unsigned int sizeX_, sizeY_;
+            int stride_;
+            double resolution_, originX_, originY_;
+            double margin_;
+            int marginCells_;
+
+            int bucketsX_, bucketsY_;
+            std::vector<unsigned char> dirty_;      // per bucket, changed since the previous update()
+            bool anyDirty_;
+
+            // cell-to-node index: the edges (by child node) crossing each bucket, as linked entries
+            std::vector<int> head_;
+            std::vector<int> entryNode_, entryNext_;
+
+            // scratch buffers reused across repairs
+            std::vector<unsigned char> state_;
+            std::vector<double> key_;
+            std::vector<Candidate> heap_;
+            std::vector<int> orphans_, stack_, neighbors_, newID_;
+
+            int invalidated_, reconnected_;
+	};
+};
+
+#endif
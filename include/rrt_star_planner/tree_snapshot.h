@@ -0,0 +1,82 @@
+#ifndef tree_snapshot_h
+#define tree_snapshot_h
+
+#include <rrt_star_planner/node_store.h>
+#include <stdint.h>
+#include <string>
+
+namespace rrtstar_planner {
+
+    /**
+    * Versioned binary file of an RRT tree, for warm starts and offline
+    * analysis. A file is a fixed header followed by the node arrays x, y and
+    * cost (double) and parent (int32), in that order, in host byte order
+    * (little-endian on every supported platform). The header starts with a
+    * magic string and a format version and records the map geometry, goal
+    * and random seed the tree was built with. New header fields are only
+    * ever appended. headerBytes tells readers where the arrays start, so the
+    * version is only bumped for incompatible changes. write() goes through a
+    * temporary file and a rename, so readers never see a partial file.
+    * open() maps the file read-only and validates it, and the accessors
+    * point straight into the mapping without copying.
+    */
+	class TreeSnapshot {
+
+        public:
+
+            static const uint32_t VERSION = 1;
+
+            /** what the tree was planned on */
+            struct Metadata
+            {
+                uint64_t seed;
+                double resolution, originX, originY;
+                uint32_t sizeX, sizeY;              // map size in cells
+                double goalX, goalY;
+            };
+
+            TreeSnapshot();
+            ~TreeSnapshot();
+
+            static bool write(const std::string &path, const NodeStore &tree, const Metadata &metadata);
+
+            bool open(const std::string &path);
+            void close();
+            bool isOpen() const { return data_ != NULL; }
+            const std::string &error() const { return error_; }
+
+            int size() const { return size_; }
+            const Metadata &metadata() const { return header()->metadata; }
+            const double* x() const { return x_; }
+            const double* y() const { return y_; }
+            const double* cost() const { return cost_; }
+            const int32_t* parent() const { return parent_; }
+
+            void load(NodeStore &tree) const;
+
+        private:
+            struct Header
+            {
+                char magic[8];
+                uint32_t version;
+                uint32_t headerBytes;           // offset of the x array
+                uint64_t nodeCount;
+                Metadata metadata;
+            };
+
+            TreeSnapshot(const TreeSnapshot&);
+            TreeSnapshot &operator=(const TreeSnapshot&);
+
+            const Header* header() const { return (const Header*)data_; }
+            bool fail(const std::string &error);
+
+            void* data_;
+            size_t bytes_;
+            int size_;
+            const double *x_, *y_, *cost_;
+            const int32_t* parent_;
+            std::string error_;
+	};
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef tree_visualizer_h
+#define tree_visualizer_h
+
+#include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
+#include <geometry_msgs/Point.h>
+#include <boost/thread.hpp>
+#include <string>
+#include <vector>
+
+namespace rrtstar_planner {
+
+    /**
+    * Rate-limited publisher for the RRT markers, running on its own thread.
+    * The planner hands over edges as they are added; at most once per period
+    * they are moved to the publisher thread, which sends only the edges added
+    * since its last publish as a new LINE_LIST marker (RViz keeps the older
+    * ones). Batches larger than the configured limit are decimated. Nothing
+    * is started when visualization is disabled. The clear of a new plan,
+    * edge batches and single markers such as the final path all go out from
+    * the publisher thread in the order they were handed over, so a clear
+    * never overtakes the path of a plan that finished within one period.
+    */
+	class TreeVisualizer {
+
+        public:
+
+            enum EdgeType { TREE_EDGE = 0, PARENT_EDGE = 1, REWIRE_EDGE = 2 };
+
+            TreeVisualizer();
+            ~TreeVisualizer();
+
+            void start(ros::NodeHandle &nh, const std::string &topic, double rate, int maxEdges);
+            void stop();
+            bool enabled() const { return running_; }
+
+            void setStyle(EdgeType type, const visualization_msgs::Marker &style);
+            void beginPlan();
+            void addEdge(EdgeType type, double startX, double startY, double endX, double endY);
+            void flush(bool force = false);
+            void publish(const visualization_msgs::Marker &marker);
+
+        private:
+            void run();
+
+            ros::Publisher publisher_;
+            boost::thread thread_;
+            boost::mutex mutex_;
+            boost::condition_variable wake_;
+            bool running_;
+            double period_;
+            int maxEdges_;
+            ros::WallTime nextFlush_;
+
+            visualization_msgs::Marker style_[3];
+            std::vector<geometry_msgs::Point> local_[3];    // filled by the planner, no locking
+            std::vector<geometry_msgs::Point> pending_[3];  // handed over, guarded by mutex_
+            std::vector<geometry_msgs::Point> sending_[3];  // owned by the publisher thread
+            std::vector<visualization_msgs::Marker> pendingMarkers_, sendingMarkers_;
+            bool clearPending_;
+            int nextMarkerID_;
+	};
+};
+
+#endif
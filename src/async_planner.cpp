@@ -0,0 +1,167 @@
+#include <rrt_star_planner/async_planner.h>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+AsyncPlanner::AsyncPlanner()
+    : running_(false), cancel_(false), replanPeriod_(0), idleTimeout_(0),
+      hasRequest_(false), goalGeneration_(0), hasResult_(false), hasPlan_(false)
+{
+
+}
+
+AsyncPlanner::~AsyncPlanner()
+{
+    stop();
+}
+
+/**
+* starts the worker thread
+* @param solve synchronous planner run by the worker; it should stop early once cancelled() is set
+* @param publish called under the lock whenever a plan is published, may be empty
+* @param replanPeriod minimum time between two plans for the same goal, 0 to plan only once per goal
+* @param idleTimeout replanning stops when no request arrived for this long
+*/
+void AsyncPlanner::start(const SolveFunction &solve, const PublishFunction &publish, double replanPeriod, double idleTimeout)
+{
+    if(running_)
+        return;
+    solve_ = solve;
+    publish_ = publish;
+    replanPeriod_ = replanPeriod;
+    idleTimeout_ = idleTimeout;
+    cancel_ = false;
+    running_ = true;
+    thread_ = boost::thread(&AsyncPlanner::run, this);
+}
+
+/**
+* cancels the running plan and joins the worker
+*/
+void AsyncPlanner::stop()
+{
+    if(!running_)
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        running_ = false;
+        cancel_ = true;
+    }
+    wake_.notify_all();
+    planReady_.notify_all();
+    thread_.join();
+}
+
+/**
+* records the newest query and returns the latest plan for its goal
+* A goal different from the previous one cancels the running search and
+* drops the old plan.
+* @param waitTime how long to block for the first plan of a new goal, 0 to return right away
+* @return false if there is no valid plan for this goal yet
+*/
+bool AsyncPlanner::request(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                           std::vector<geometry_msgs::PoseStamped> &plan, double waitTime)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if(!hasRequest_ || !sameGoal(goal, goal_))
+    {
+        goalGeneration_++;
+        hasResult_ = false;
+        hasPlan_ = false;
+        plan_.clear();
+        cancel_ = true;
+    }
+    hasRequest_ = true;
+    start_ = start;
+    goal_ = goal;
+    lastRequest_ = ros::WallTime::now();
+    wake_.notify_all();
+
+    if(!hasResult_ && waitTime > 0)
+        planReady_.timed_wait(lock, boost::posix_time::microseconds(long(waitTime * 1e6)),
+                              [this]() { return hasResult_ || !running_; });
+
+    plan.clear();
+    if(hasPlan_)
+        plan = plan_;
+    return hasPlan_;
+}
+
+/**
+* runs read under the lock that guards the published plan, so it sees what
+* the publish callback copied for the latest plan and never a half-written one
+*/
+void AsyncPlanner::readPublished(const boost::function<void ()> &read)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    read();
+}
+
+/**
+* goals are the same if frame, position and orientation match
+*/
+bool AsyncPlanner::sameGoal(const geometry_msgs::PoseStamped &a, const geometry_msgs::PoseStamped &b)
+{
+    const geometry_msgs::Pose &p = a.pose, &q = b.pose;
+    return a.header.frame_id == b.header.frame_id &&
+           hypot(p.position.x - q.position.x, p.position.y - q.position.y) < 1e-3 &&
+           fabs(p.orientation.x - q.orientation.x) < 1e-3 && fabs(p.orientation.y - q.orientation.y) < 1e-3 &&
+           fabs(p.orientation.z - q.orientation.z) < 1e-3 && fabs(p.orientation.w - q.orientation.w) < 1e-3;
+}
+
+void AsyncPlanner::run()
+{
+    std::vector<geometry_msgs::PoseStamped> plan;
+    unsigned long solvedGeneration = 0;
+    ros::WallTime nextSolve;
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while(running_)
+    {
+        if(!hasRequest_)
+        {
+            wake_.wait(lock);
+            continue;
+        }
+        //新目标立即规划；同一目标按周期从最新的起点重新规划，直到一段时间没有请求
+        ros::WallTime now = ros::WallTime::now();
+        bool newGoal = solvedGeneration != goalGeneration_;
+        bool idle = replanPeriod_ <= 0 || (now - lastRequest_).toSec() >= idleTimeout_;
+        if(!newGoal && idle)
+        {
+            wake_.wait(lock);
+            continue;
+        }
+        if(!newGoal && now < nextSolve)
+        {
+            wake_.timed_wait(lock, boost::posix_time::microseconds((nextSolve - now).toNSec() / 1000));
+            continue;
+        }
+
+        geometry_msgs::PoseStamped start = start_, goal = goal_;
+        unsigned long generation = goalGeneration_;
+        cancel_ = false;
+        lock.unlock();
+
+        bool found = solve_(start, goal, plan);
+
+        lock.lock();
+        solvedGeneration = generation;
+        nextSolve = ros::WallTime::now() + ros::WallDuration(max(replanPeriod_, 0.0));
+        //规划期间目标已经改变，结果作废
+        if(generation != goalGeneration_)
+            continue;
+        hasResult_ = true;
+        hasPlan_ = found;
+        plan_.swap(plan);
+        if(!found)
+            plan_.clear();
+        if(publish_)
+            publish_();
+        planReady_.notify_all();
+    }
+}
+
+}
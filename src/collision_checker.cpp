@@ -0,0 +1,265 @@
+#include <rrt_star_planner/collision_checker.h>
+#include <algorithm>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+    static const double SQRT2 = 1.4142135623730951;
+
+/**
+* calls test(row, firstCell, lastCell) for the run of cells the segment
+* covers in each map row, from the start row towards the end row
+* Coordinates are continuous map coordinates (one unit per cell); stops and
+* returns false as soon as a test fails.
+*/
+template <class RunTest>
+static bool walkRows(double fx0, double fy0, double fx1, double fy1, int sizeX, RunTest test)
+{
+    int row0 = int(fy0), row1 = int(fy1);
+    if(row0 == row1)
+    {
+        int c0 = int(min(fx0, fx1)), c1 = min(int(max(fx0, fx1)), sizeX - 1);
+        return test(row0, c0, c1);
+    }
+
+    int step = row1 > row0 ? 1 : -1;
+    double dxdy = (fx1 - fx0) / (fy1 - fy0);
+    double yLo = min(fy0, fy1), yHi = max(fy0, fy1);
+    for(int row=row0; ; row+=step)
+    {
+        double ya = max(double(row), yLo), yb = min(double(row + 1), yHi);
+        double xa = fx0 + (ya - fy0) * dxdy, xb = fx0 + (yb - fy0) * dxdy;
+        int c0 = max(int(min(xa, xb)), 0), c1 = min(int(max(xa, xb)), sizeX - 1);
+        if(!test(row, c0, c1))
+            return false;
+        if(row == row1)
+            break;
+    }
+    return true;
+}
+
+struct SnapshotRunTest
+{
+    const CostmapSnapshot* map;
+    bool operator()(int row, int c0, int c1) const
+    {
+        return map->runFree(row, c0, c1);
+    }
+};
+
+struct ClearanceRunTest
+{
+    const float* dist;
+    int sizeX;
+    float minCells;
+    bool operator()(int row, int c0, int c1) const
+    {
+        const float* cells = dist + row * sizeX;
+        for(int c=c0; c<=c1; c++)
+        {
+            if(cells[c] <= minCells)
+                return false;
+        }
+        return true;
+    }
+};
+
+struct FootprintRunTest
+{
+    const CollisionChecker* checker;
+    int heading;
+    bool operator()(int row, int c0, int c1) const
+    {
+        for(int c=c0; c<=c1; c++)
+        {
+            if(!checker->footprintCellFree(heading, c, row))
+                return false;
+        }
+        return true;
+    }
+};
+
+CollisionChecker::CollisionChecker()
+    : map_(NULL), field_(NULL), minClearance_(0), masks_(NULL)
+{
+
+}
+
+/**
+* @param map snapshot kept up to date by the owner; all queries read it instead of the costmap
+*/
+void CollisionChecker::setSnapshot(const CostmapSnapshot* map)
+{
+    map_ = map;
+}
+
+/**
+* switches the checks over to clearance lookups in the given distance field
+* @param field distance field kept up to date by the owner, NULL to go back to the char map
+* @param minClearance required distance (meters, between cell centers) to the nearest blocked cell
+*/
+void CollisionChecker::setDistanceField(const DistanceField* field, double minClearance)
+{
+    field_ = field;
+    minClearance_ = minClearance;
+}
+
+/**
+* checks poses and edges with the robot footprint instead of a point
+* @param masks masks kept up to date by the owner, NULL or empty to go back to point checks
+*/
+void CollisionChecker::setFootprint(const FootprintMasks* masks)
+{
+    masks_ = masks;
+}
+
+/**
+* tests the runs of one footprint mask placed on the given cell
+* Cells off the map are treated like unknown cells, i.e. free. The snapshot
+* is in lethal-only mode while footprint checks are on.
+*/
+bool CollisionChecker::maskFree(int mask, int cx, int cy) const
+{
+    const int sizeX = map_->getSizeInCellsX(), sizeY = map_->getSizeInCellsY();
+    for(const FootprintMasks::Run* run = masks_->begin(mask); run != masks_->end(mask); ++run)
+    {
+        int y = cy + run->dy;
+        int x0 = max(cx + run->dx0, 0), x1 = min(cx + run->dx1, sizeX - 1);
+        if(y < 0 || y >= sizeY || x0 > x1)
+            continue;
+        if(!map_->runFree(y, x0, x1))
+            return false;
+    }
+    return true;
+}
+
+/**
+* footprint check of the center cell for one heading, skipped where the
+* distance field shows no obstacle within reach of the footprint
+*/
+bool CollisionChecker::footprintCellFree(int heading, int cx, int cy) const
+{
+    const double res = map_->getResolution();
+    if(field_ && field_->cellDistance(cx, cy) * res > masks_->circumscribedRadius() + res * SQRT2)
+        return true;
+    return maskFree(heading, cx, cy);
+}
+
+/**
+* checks the cell containing the given point
+* With a footprint the pose is free if the robot fits there at any heading.
+*/
+bool CollisionChecker::pointFree(double X, double Y) const
+{
+    unsigned int gridx, gridy;
+    if(!map_->worldToMap(X, Y, gridx, gridy))
+        return false;
+    if(masks_ && !masks_->empty())
+    {
+        if(!maskFree(masks_->headings(), gridx, gridy))
+            return false;
+        for(int h=0; h<masks_->headings(); h++)
+        {
+            if(footprintCellFree(h, gridx, gridy))
+                return true;
+        }
+        return false;
+    }
+    if(field_)
+        return field_->cellDistance(gridx, gridy) * map_->getResolution() > minClearance_;
+    return !map_->blocked(gridx, gridy);
+}
+
+/**
+* checks the robot at the given point with the given heading; without a
+* footprint this is the point check
+*/
+bool CollisionChecker::poseFree(double X, double Y, double theta) const
+{
+    if(!masks_ || masks_->empty())
+        return pointFree(X, Y);
+    unsigned int gridx, gridy;
+    if(!map_->worldToMap(X, Y, gridx, gridy))
+        return false;
+    return footprintCellFree(masks_->headingIndex(theta), gridx, gridy);
+}
+
+/**
+* checks every cell touched by the segment between two points
+* Rows are visited from the start point towards the end point; within a row
+* the segment covers a contiguous run of cells bounded by where it enters
+* and leaves the row, which is tested a 64-cell word at a time. Returns at the first
+* blocked run.
+*/
+bool CollisionChecker::segmentFree(double startX, double startY, double endX, double endY) const
+{
+    unsigned int mx, my;
+    if(!map_->worldToMap(startX, startY, mx, my) || !map_->worldToMap(endX, endY, mx, my))
+        return false;
+
+    const int sizeX = map_->getSizeInCellsX();
+    const double res = map_->getResolution();
+    // continuous map coordinates, one unit per cell
+    double fx0 = (startX - map_->getOriginX()) / res, fy0 = (startY - map_->getOriginY()) / res;
+    double fx1 = (endX - map_->getOriginX()) / res, fy1 = (endY - map_->getOriginY()) / res;
+
+    if(masks_ && !masks_->empty())
+    {
+        FootprintRunTest test = {this, masks_->headingIndex(atan2(endY - startY, endX - startX))};
+        return walkRows(fx0, fy0, fx1, fy1, sizeX, test);
+    }
+    if(field_)
+        return segmentClearanceFree(fx0, fy0, fx1, fy1);
+    SnapshotRunTest test = {map_};
+    return walkRows(fx0, fy0, fx1, fy1, sizeX, test);
+}
+
+/**
+* edge check against the distance field
+* From a point whose cell has clearance d, every cell within d - minimum -
+* sqrt(2) cells (the sqrt(2) covers both points' offsets from their cell
+* centers) is known to be free, so the walk jumps ahead by that much. Near
+* obstacles it falls back to checking one cell length at a time exactly.
+*/
+bool CollisionChecker::segmentClearanceFree(double fx0, double fy0, double fx1, double fy1) const
+{
+    const float* dist = field_->data();
+    const int sizeX = field_->getSizeInCellsX();
+    const float minCells = float(minClearance_ / map_->getResolution());
+    ClearanceRunTest test = {dist, sizeX, minCells};
+
+    double dx = fx1 - fx0, dy = fy1 - fy0;
+    double length = sqrt(dx * dx + dy * dy);
+    if(length == 0)
+        return dist[int(fy0) * sizeX + int(fx0)] > minCells;
+    double ux = dx / length, uy = dy / length;
+
+    double t = 0;
+    while(true)
+    {
+        double px = fx0 + ux * t, py = fy0 + uy * t;
+        float d = dist[int(py) * sizeX + int(px)];
+        if(d <= minCells)
+            return false;
+        double skip = d - minCells - SQRT2;
+        if(skip >= 1.0)
+        {
+            t += skip;
+            if(t >= length)
+                return true;
+        }
+        else
+        {
+            double t1 = min(length, t + 1.0);
+            if(!walkRows(px, py, fx0 + ux * t1, fy0 + uy * t1, sizeX, test))
+                return false;
+            t = t1;
+            if(t >= length)
+                return true;
+        }
+    }
+}
+
+}
@@ -0,0 +1,185 @@
+#include <rrt_star_planner/costmap_snapshot.h>
+#include <costmap_2d/cost_values.h>
+#include <boost/thread/locks.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace rrtstar_planner{
+
+    using namespace std;
+    using costmap_2d::NO_INFORMATION;
+    using costmap_2d::FREE_SPACE;
+    using costmap_2d::LETHAL_OBSTACLE;
+
+    static const uint64_t ALL_BLOCKED = ~uint64_t(0);
+
+CostmapSnapshot::CostmapSnapshot()
+    : lethalOnly_(false), sizeX_(0), sizeY_(0), resolution_(0), originX_(0), originY_(0), stride_(0), bits_(NULL)
+{
+
+}
+
+/**
+* @param lethalOnly only LETHAL_OBSTACLE cells block, for footprint checks
+*/
+void CostmapSnapshot::setLethalOnly(bool lethalOnly)
+{
+    if(lethalOnly == lethalOnly_)
+        return;
+    lethalOnly_ = lethalOnly;
+    bits_ = NULL;
+}
+
+/**
+* copies the whole costmap
+* @return true if any bit or the map geometry changed
+*/
+bool CostmapSnapshot::update(costmap_2d::Costmap2D &costmap)
+{
+    double inf = numeric_limits<double>::infinity();
+    return update(costmap, -inf, -inf, inf, inf);
+}
+
+/**
+* copies the cells of the costmap inside [minX,maxX]x[minY,maxY] (meters)
+* and marks every other cell blocked
+* The costmap's mutex is held only while the region is packed.
+* @return true if any bit or the map geometry changed
+*/
+bool CostmapSnapshot::update(costmap_2d::Costmap2D &costmap, double minX, double minY, double maxX, double maxY)
+{
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*costmap.getMutex());
+    unsigned int sx = costmap.getSizeInCellsX(), sy = costmap.getSizeInCellsY();
+    bool changed = false;
+    if(!bits_ || sx != sizeX_ || sy != sizeY_ || costmap.getResolution() != resolution_ ||
+       costmap.getOriginX() != originX_ || costmap.getOriginY() != originY_)
+    {
+        sizeX_ = sx;
+        sizeY_ = sy;
+        resolution_ = costmap.getResolution();
+        originX_ = costmap.getOriginX();
+        originY_ = costmap.getOriginY();
+        stride_ = ((sx + 63) / 64 + 7) & ~7;
+        storage_.assign(size_t(stride_) * sy + 8, ALL_BLOCKED);
+        bits_ = storage_.data() + ((64 - uintptr_t(storage_.data()) % 64) % 64) / sizeof(uint64_t);
+        changed = true;
+    }
+    if(sx == 0 || sy == 0)
+        return changed;
+
+    //区域换算成栅格范围，区域外的栅格一律视为障碍
+    double fx0 = min(max(0.0, (minX - originX_) / resolution_), double(sx));
+    double fy0 = min(max(0.0, (minY - originY_) / resolution_), double(sy));
+    double fx1 = max(min(sx - 1.0, (maxX - originX_) / resolution_), -1.0);
+    double fy1 = max(min(sy - 1.0, (maxY - originY_) / resolution_), -1.0);
+    int x0 = int(fx0), y0 = int(fy0), x1 = int(floor(fx1)), y1 = int(floor(fy1));
+
+    const unsigned char* grid = costmap.getCharMap();
+    for(unsigned int y=0; y<sy; y++)
+    {
+        uint64_t* out = bits_ + y * stride_;
+        if(int(y) < y0 || int(y) > y1 || x0 > x1)
+        {
+            for(int w=0; w<stride_; w++)
+            {
+                changed |= out[w] != ALL_BLOCKED;
+                out[w] = ALL_BLOCKED;
+            }
+            continue;
+        }
+        for(int w=0; w<stride_; w++)
+        {
+            if(w * 64 + 63 < x0 || w * 64 > x1)
+            {
+                changed |= out[w] != ALL_BLOCKED;
+                out[w] = ALL_BLOCKED;
+            }
+        }
+        changed |= packRow(grid + y * sx, out, x0, x1);
+    }
+    return changed;
+}
+
+/**
+* packs the cells [x0,x1] of one row into the blocked bits of out; bits of
+* those words outside [x0,x1] are set blocked
+* Whole words are packed 16 cells at a time with SSE2 compares.
+* @return true if any word changed
+*/
+bool CostmapSnapshot::packRow(const unsigned char* cells, uint64_t* out, int x0, int x1) const
+{
+    bool changed = false;
+    for(int w=x0 >> 6; w<=(x1 >> 6); w++)
+    {
+        int c0 = w * 64;
+        uint64_t word = 0;
+        int c = c0;
+        if(c0 >= x0 && c0 + 63 <= x1)
+        {
+#ifdef __SSE2__
+            const __m128i one = _mm_set1_epi8(1);
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i lethal = _mm_set1_epi8(char(LETHAL_OBSTACLE));
+            for(int k=0; k<4; k++)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(cells + c0 + 16 * k));
+                unsigned int mask;
+                if(lethalOnly_)
+                    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, lethal));
+                else
+                    mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(_mm_add_epi8(v, one), one), zero)) & 0xFFFF;
+                word |= uint64_t(mask) << (16 * k);
+            }
+            c = c0 + 64;
+#endif
+        }
+        for(; c<c0 + 64; c++)
+        {
+            bool blocked = true;
+            if(c >= x0 && c <= x1)
+            {
+                unsigned char cost = cells[c];
+                blocked = lethalOnly_ ? cost == LETHAL_OBSTACLE : cost != FREE_SPACE && cost != NO_INFORMATION;
+            }
+            word |= uint64_t(blocked) << (c - c0);
+        }
+        changed |= out[w] != word;
+        out[w] = word;
+    }
+    return changed;
+}
+
+bool CostmapSnapshot::worldToMap(double X, double Y, unsigned int &mx, unsigned int &my) const
+{
+    if(X < originX_ || Y < originY_)
+        return false;
+    mx = (unsigned int)((X - originX_) / resolution_);
+    my = (unsigned int)((Y - originY_) / resolution_);
+    return mx < sizeX_ && my < sizeY_;
+}
+
+/**
+* returns true if no cell in [x0,x1] of the row is blocked
+*/
+bool CostmapSnapshot::runFree(unsigned int my, int x0, int x1) const
+{
+    const uint64_t* bits = row(my);
+    int w0 = x0 >> 6, w1 = x1 >> 6;
+    uint64_t first = ALL_BLOCKED << (x0 & 63), last = ALL_BLOCKED >> (63 - (x1 & 63));
+    if(w0 == w1)
+        return (bits[w0] & first & last) == 0;
+    if(bits[w0] & first)
+        return false;
+    for(int w=w0 + 1; w<w1; w++)
+    {
+        if(bits[w])
+            return false;
+    }
+    return (bits[w1] & last) == 0;
+}
+
+}
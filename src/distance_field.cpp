@@ -0,0 +1,175 @@
+#include <rrt_star_planner/distance_field.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+    static const double INF_DIST = 1e20;
+
+DistanceField::DistanceField()
+    : sizeX_(0), sizeY_(0), stride_(0), resolution_(0), originX_(0), originY_(0), maxDistance_(1.0), capCells_(0)
+{
+
+}
+
+/**
+* sets the distance (in meters) beyond which cells are simply "far"
+* The next update() recomputes the whole field.
+*/
+void DistanceField::setMaxDistance(double maxDistance)
+{
+    maxDistance_ = maxDistance;
+    lastBits_.clear();
+}
+
+/**
+* brings the field in line with the map snapshot
+* Only the bounding box of changed cells, grown by the maximum distance, is
+* recomputed; a resized or moved costmap triggers a full recompute.
+* @return true if any cell changed
+*/
+bool DistanceField::update(const CostmapSnapshot &map)
+{
+    unsigned int sx = map.getSizeInCellsX(), sy = map.getSizeInCellsY();
+    int stride = map.stride();
+    if(sx != sizeX_ || sy != sizeY_ || map.getResolution() != resolution_ ||
+       map.getOriginX() != originX_ || map.getOriginY() != originY_ || lastBits_.size() != size_t(stride) * sy)
+    {
+        sizeX_ = sx;
+        sizeY_ = sy;
+        stride_ = stride;
+        resolution_ = map.getResolution();
+        originX_ = map.getOriginX();
+        originY_ = map.getOriginY();
+        capCells_ = max(1, int(ceil(maxDistance_ / resolution_)));
+        lastBits_.resize(size_t(stride) * sy);
+        for(unsigned int y=0; y<sy; y++)
+            memcpy(&lastBits_[y * stride], map.row(y), stride * sizeof(uint64_t));
+        dist_.assign(sx * sy, float(capCells_));
+        if(sx > 0 && sy > 0)
+            recompute(0, 0, sx - 1, sy - 1);
+        return true;
+    }
+
+    //按64个栅格一个字比较，变化范围精确到字
+    int minX = sx, minY = sy, maxX = -1, maxY = -1;
+    for(unsigned int y=0; y<sy; y++)
+    {
+        const uint64_t* row = map.row(y);
+        uint64_t* last = &lastBits_[y * stride];
+        if(memcmp(row, last, stride * sizeof(uint64_t)) == 0)
+            continue;
+        int first = 0, end = stride - 1;
+        while(row[first] == last[first])
+            first++;
+        while(row[end] == last[end])
+            end--;
+        minX = min(minX, first * 64);
+        maxX = max(maxX, min(end * 64 + 63, int(sx) - 1));
+        minY = min(minY, int(y));
+        maxY = int(y);
+        memcpy(last, row, stride * sizeof(uint64_t));
+    }
+    if(maxY < 0)
+        return false;
+
+    recompute(max(0, minX - capCells_), max(0, minY - capCells_),
+              min(int(sx) - 1, maxX + capCells_), min(int(sy) - 1, maxY + capCells_));
+    return true;
+}
+
+/**
+* recomputes the distances of the cells in [x0,x1]x[y0,y1]
+* Obstacles up to capCells_ outside the region can still be the nearest
+* one, so the transform runs over the region grown by that margin.
+*/
+void DistanceField::recompute(int x0, int y0, int x1, int y1)
+{
+    int wx0 = max(0, x0 - capCells_), wy0 = max(0, y0 - capCells_);
+    int wx1 = min(int(sizeX_) - 1, x1 + capCells_), wy1 = min(int(sizeY_) - 1, y1 + capCells_);
+    int w = wx1 - wx0 + 1, h = wy1 - wy0 + 1;
+    int n = max(w, h);
+    window_.resize(w * h);
+    f_.resize(n);
+    d_.resize(n);
+    z_.resize(n + 1);
+    v_.resize(n);
+
+    // columns first, squared distances stay in the window
+    for(int x=0; x<w; x++)
+    {
+        for(int y=0; y<h; y++)
+        {
+            int cx = wx0 + x;
+            bool blocked = (lastBits_[(wy0 + y) * stride_ + (cx >> 6)] >> (cx & 63)) & 1;
+            f_[y] = blocked ? 0.0 : INF_DIST;
+        }
+        transform1D(h);
+        for(int y=0; y<h; y++)
+            window_[y * w + x] = d_[y];
+    }
+
+    // then only the rows of the region itself
+    float cap = float(capCells_);
+    for(int y=y0; y<=y1; y++)
+    {
+        const double* row = &window_[(y - wy0) * w];
+        for(int x=0; x<w; x++)
+            f_[x] = row[x];
+        transform1D(w);
+        float* out = &dist_[y * sizeX_];
+        for(int x=x0; x<=x1; x++)
+            out[x] = min(cap, float(sqrt(d_[x - wx0])));
+    }
+}
+
+/**
+* one dimensional squared distance transform of f_[0..n) into d_
+* (lower envelope of parabolas, Felzenszwalb and Huttenlocher)
+*/
+void DistanceField::transform1D(int n)
+{
+    int k = 0;
+    v_[0] = 0;
+    z_[0] = -INF_DIST;
+    z_[1] = INF_DIST;
+    for(int q=1; q<n; q++)
+    {
+        if(f_[q] >= INF_DIST)
+            continue;
+        if(f_[v_[k]] >= INF_DIST)
+        {
+            v_[k] = q;
+            continue;
+        }
+        double s = ((f_[q] + q * q) - (f_[v_[k]] + v_[k] * v_[k])) / (2.0 * q - 2.0 * v_[k]);
+        while(s <= z_[k])
+        {
+            k--;
+            s = ((f_[q] + q * q) - (f_[v_[k]] + v_[k] * v_[k])) / (2.0 * q - 2.0 * v_[k]);
+        }
+        k++;
+        v_[k] = q;
+        z_[k] = s;
+        z_[k + 1] = INF_DIST;
+    }
+    if(f_[v_[0]] >= INF_DIST)
+    {
+        for(int q=0; q<n; q++)
+            d_[q] = INF_DIST;
+        return;
+    }
+    k = 0;
+    for(int q=0; q<n; q++)
+    {
+        while(z_[k + 1] < q)
+            k++;
+        double dq = q - v_[k];
+        d_[q] = dq * dq + f_[v_[k]];
+    }
+}
+
+}
@@ -0,0 +1,157 @@
+#include <rrt_star_planner/footprint_masks.h>
+#include <algorithm>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+using namespace std;
+
+static const double SQRT2 = 1.4142135623730951;
+
+static double segmentDistance(double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx - ax, dy = by - ay;
+    double length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? ((px - ax) * dx + (py - ay) * dy) / length2 : 0;
+    t = max(0.0, min(1.0, t));
+    return hypot(px - ax - t * dx, py - ay - t * dy);
+}
+
+/**
+* distance from the point to the polygon, 0 inside it
+*/
+static double polygonDistance(const vector<double> &polyX, const vector<double> &polyY, double px, double py)
+{
+    int n = polyX.size();
+    bool inside = false;
+    double dist = 1e300;
+    for(int i=0, j=n-1; i<n; j=i++)
+    {
+        if((polyY[i] > py) != (polyY[j] > py) &&
+           px < polyX[j] + (py - polyY[j]) * (polyX[i] - polyX[j]) / (polyY[i] - polyY[j]))
+            inside = !inside;
+        dist = min(dist, segmentDistance(px, py, polyX[j], polyY[j], polyX[i], polyY[i]));
+    }
+    return inside ? 0 : dist;
+}
+
+FootprintMasks::FootprintMasks()
+    : headings_(16), resolution_(0), circumscribed_(0), inscribed_(0)
+{
+
+}
+
+/**
+* @param headings number of heading bins over the full circle, the masks are rebuilt on the next update
+*/
+void FootprintMasks::setHeadings(int headings)
+{
+    headings_ = max(1, headings);
+    runs_.clear();
+}
+
+/**
+* rebuilds the masks if the footprint or the resolution changed
+* @param footprint polygon in the robot frame, fewer than three points disables the masks
+* @return true if the masks were rebuilt
+*/
+bool FootprintMasks::update(const vector<geometry_msgs::Point> &footprint, double resolution)
+{
+    bool same = resolution == resolution_ && footprint.size() == footprint_.size() && !runs_.empty();
+    for(size_t i=0; same && i<footprint.size(); i++)
+        same = footprint[i].x == footprint_[i].x && footprint[i].y == footprint_[i].y;
+    if(same)
+        return false;
+
+    footprint_ = footprint;
+    resolution_ = resolution;
+    runs_.clear();
+    start_.clear();
+    if(empty())
+        return true;
+
+    circumscribed_ = 0;
+    inscribed_ = 1e300;
+    int n = footprint_.size();
+    for(int i=0, j=n-1; i<n; j=i++)
+    {
+        circumscribed_ = max(circumscribed_, hypot(footprint_[i].x, footprint_[i].y));
+        inscribed_ = min(inscribed_, segmentDistance(0, 0, footprint_[j].x, footprint_[j].y, footprint_[i].x, footprint_[i].y));
+    }
+
+    //中心在栅格内任意位置、朝向在区间内任意角度时足迹能碰到的栅格都算进掩码
+    double halfBin = M_PI / headings_;
+    double margin = resolution_ * SQRT2 + 2 * circumscribed_ * sin(halfBin / 2);
+    for(int h=0; h<headings_; h++)
+    {
+        start_.push_back(runs_.size());
+        rasterize(2 * M_PI * h / headings_, margin);
+    }
+    start_.push_back(runs_.size());
+    rasterizeInscribed();
+    start_.push_back(runs_.size());
+    return true;
+}
+
+int FootprintMasks::headingIndex(double theta) const
+{
+    int index = int(floor(theta * headings_ / (2 * M_PI) + 0.5)) % headings_;
+    return index < 0 ? index + headings_ : index;
+}
+
+/**
+* appends the runs of the cells within margin of the footprint rotated by theta
+*/
+void FootprintMasks::rasterize(double theta, double margin)
+{
+    int n = footprint_.size();
+    polyX_.resize(n);
+    polyY_.resize(n);
+    double c = cos(theta), s = sin(theta);
+    for(int i=0; i<n; i++)
+    {
+        polyX_[i] = c * footprint_[i].x - s * footprint_[i].y;
+        polyY_[i] = s * footprint_[i].x + c * footprint_[i].y;
+    }
+
+    int extent = int(ceil((circumscribed_ + margin) / resolution_));
+    for(int dy=-extent; dy<=extent; dy++)
+    {
+        int runStart = 0;
+        bool inRun = false;
+        for(int dx=-extent; dx<=extent + 1; dx++)
+        {
+            bool covered = dx <= extent && polygonDistance(polyX_, polyY_, dx * resolution_, dy * resolution_) <= margin;
+            if(covered && !inRun)
+                runStart = dx;
+            else if(!covered && inRun)
+            {
+                Run run = {dy, runStart, dx - 1};
+                runs_.push_back(run);
+            }
+            inRun = covered;
+        }
+    }
+}
+
+/**
+* appends the runs of the cells the inscribed circle overlaps wherever the
+* center is in its cell, always including that cell itself
+*/
+void FootprintMasks::rasterizeInscribed()
+{
+    int extent = int(ceil(inscribed_ / resolution_));
+    for(int dy=-extent; dy<=extent; dy++)
+    {
+        int dx = extent;
+        while(dx >= 0 && (hypot(dx, dy) + SQRT2 / 2) * resolution_ >= inscribed_ && (dx != 0 || dy != 0))
+            dx--;
+        if(dx >= 0)
+        {
+            Run run = {dy, -dx, dx};
+            runs_.push_back(run);
+        }
+    }
+}
+
+}
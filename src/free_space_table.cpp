@@ -0,0 +1,153 @@
+#include <rrt_star_planner/free_space_table.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace rrtstar_planner{
+
+using namespace std;
+
+FreeSpaceTable::FreeSpaceTable()
+    : sizeX_(0), sizeY_(0), stride_(0), resolution_(0), originX_(0), originY_(0), margin_(0), begin_(0), end_(0)
+{
+
+}
+
+/**
+* updates the free cell list if the map snapshot changed since the last update
+* A cell is listed if the collision checker accepts its center. Only cells
+* within the margin of changed cells are tested again, all of them after
+* the map was resized or moved or invalidate() was called. The components,
+* if given, have to be up to date with the same snapshot.
+* @return true if the list was rebuilt
+*/
+bool FreeSpaceTable::update(const CostmapSnapshot &map, const CollisionChecker &checker,
+                            const ReachabilityMap* components)
+{
+    unsigned int sx = map.getSizeInCellsX(), sy = map.getSizeInCellsY();
+    int stride = map.stride();
+    if(sx != sizeX_ || sy != sizeY_ || map.getResolution() != resolution_ || map.getOriginX() != originX_ ||
+       map.getOriginY() != originY_ || lastBits_.size() != size_t(stride) * sy)
+    {
+        sizeX_ = sx;
+        sizeY_ = sy;
+        stride_ = stride;
+        resolution_ = map.getResolution();
+        originX_ = map.getOriginX();
+        originY_ = map.getOriginY();
+        lastBits_.resize(size_t(stride) * sy);
+        for(unsigned int y=0; y<sy; y++)
+            memcpy(&lastBits_[y * stride], map.row(y), stride * sizeof(uint64_t));
+        freeBits_.assign(size_t(stride) * sy, 0);
+        for(unsigned int y=0; y<sy; y++)
+            testCells(checker, y, 0, int(sx) - 1);
+    }
+    else
+    {
+        //变化的栅格向四周扩展margin，得到每一行需要重新检查的范围
+        int margin = resolution_ > 0 ? int(ceil(margin_ / resolution_)) + 1 : 0;
+        spanX0_.assign(sy, int(sx));
+        spanX1_.assign(sy, -1);
+        bool changed = false;
+        for(unsigned int y=0; y<sy; y++)
+        {
+            const uint64_t* row = map.row(y);
+            uint64_t* last = &lastBits_[y * stride];
+            if(memcmp(row, last, stride * sizeof(uint64_t)) == 0)
+                continue;
+            int first = 0, end = stride - 1;
+            while(row[first] == last[first])
+                first++;
+            while(row[end] == last[end])
+                end--;
+            int x0 = max(0, first * 64 + __builtin_ctzll(row[first] ^ last[first]) - margin);
+            int x1 = min(int(sx) - 1, end * 64 + 63 - __builtin_clzll(row[end] ^ last[end]) + margin);
+            for(int yy=max(0, int(y) - margin); yy<=min(int(sy) - 1, int(y) + margin); yy++)
+            {
+                spanX0_[yy] = min(spanX0_[yy], x0);
+                spanX1_[yy] = max(spanX1_[yy], x1);
+            }
+            memcpy(last, row, stride * sizeof(uint64_t));
+            changed = true;
+        }
+        if(!changed)
+            return false;
+        for(unsigned int y=0; y<sy; y++)
+        {
+            if(spanX0_[y] <= spanX1_[y])
+                testCells(checker, y, spanX0_[y], spanX1_[y]);
+        }
+    }
+
+    //从空闲位逐字收集空闲栅格和它们所在的连通域，再按连通域计数排序
+    free_.clear();
+    group_.clear();
+    int groups = 1;
+    for(unsigned int y=0; y<sy; y++)
+    {
+        const uint64_t* bits = &freeBits_[y * stride_];
+        double wy = originY_ + (y + 0.5) * resolution_;
+        for(int w=0; w<stride_; w++)
+        {
+            for(uint64_t word=bits[w]; word; word&=word - 1)
+            {
+                unsigned int x = w * 64 + __builtin_ctzll(word);
+                int group = components ? components->component(originX_ + (x + 0.5) * resolution_, wy) + 1 : 0;
+                free_.push_back(y * sx + x);
+                group_.push_back(group);
+                groups = max(groups, group + 1);
+            }
+        }
+    }
+
+    groupStart_.assign(groups + 1, 0);
+    for(size_t i=0; i<group_.size(); i++)
+        groupStart_[group_[i] + 1]++;
+    for(int g=0; g<groups; g++)
+        groupStart_[g + 1] += groupStart_[g];
+    cells_.resize(free_.size());
+    for(size_t i=0; i<free_.size(); i++)
+        cells_[groupStart_[group_[i]]++] = free_[i];
+    for(int g=groups; g>0; g--)
+        groupStart_[g] = groupStart_[g - 1];
+    groupStart_[0] = 0;
+
+    begin_ = 0;
+    end_ = cells_.size();
+    return true;
+}
+
+/**
+* tests the cells [x0,x1] of row y with the collision checker and stores the result in freeBits_
+*/
+void FreeSpaceTable::testCells(const CollisionChecker &checker, unsigned int y, int x0, int x1)
+{
+    uint64_t* bits = &freeBits_[y * stride_];
+    double wy = originY_ + (y + 0.5) * resolution_;
+    for(int x=x0; x<=x1; x++)
+    {
+        uint64_t bit = uint64_t(1) << (x & 63);
+        if(checker.pointFree(originX_ + (x + 0.5) * resolution_, wy))
+            bits[x >> 6] |= bit;
+        else
+            bits[x >> 6] &= ~bit;
+    }
+}
+
+/**
+* samples only from the cells of one component, -1 for all free cells
+*/
+void FreeSpaceTable::restrictTo(int component)
+{
+    int group = component + 1;
+    if(component < 0 || group + 1 >= (int)groupStart_.size())
+    {
+        begin_ = 0;
+        end_ = cells_.size();
+        return;
+    }
+    begin_ = groupStart_[group];
+    end_ = groupStart_[group + 1];
+}
+
+}
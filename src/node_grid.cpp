@@ -0,0 +1,421 @@
+#include <rrt_star_planner/node_grid.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+/**
+* heap order for nearestK: the farthest candidate (the higher id on ties) is on top
+*/
+struct FartherFirst
+{
+    const double *posX, *posY;
+    double X, Y;
+    double dist(int id) const
+    {
+        double dx = posX[id] - X, dy = posY[id] - Y;
+        return dx*dx + dy*dy;
+    }
+    bool operator()(int a, int b) const
+    {
+        double da = dist(a), db = dist(b);
+        return da < db || (da == db && a < b);
+    }
+};
+
+static inline void offerK(vector<int> &heap, int k, int id, const FartherFirst &order)
+{
+    if((int)heap.size() < k)
+    {
+        heap.push_back(id);
+        push_heap(heap.begin(), heap.end(), order);
+    }
+    else if(order(id, heap.front()))
+    {
+        pop_heap(heap.begin(), heap.end(), order);
+        heap.back() = id;
+        push_heap(heap.begin(), heap.end(), order);
+    }
+}
+
+NodeGrid::NodeGrid()
+    : originX_(0), originY_(0), cellSize_(1.0), cellsX_(0), cellsY_(0), limit_(0), count_(0),
+      minCellX_(numeric_limits<int>::max()), minCellY_(numeric_limits<int>::max()), maxCellX_(-1), maxCellY_(-1)
+{
+
+}
+
+/**
+* Sets the area covered by the grid and empties it
+* @param originX, originY lower left corner of the covered area
+* @param sizeX, sizeY extent of the covered area in meters
+* @param cellSize edge length of one bucket in meters
+*/
+void NodeGrid::configure(double originX, double originY, double sizeX, double sizeY, double cellSize)
+{
+    clear();
+    originX_ = originX;
+    originY_ = originY;
+    cellSize_ = cellSize;
+    cellsX_ = max(1, int(ceil(sizeX / cellSize)));
+    cellsY_ = max(1, int(ceil(sizeY / cellSize)));
+    head_.assign(cellsX_ * cellsY_, -1);
+}
+
+/**
+* Removes every node while keeping the allocated buckets
+*/
+void NodeGrid::clear()
+{
+    for(size_t i=0; i<cell_.size(); i++)
+    {
+        if(cell_[i] >= 0)
+            head_[cell_[i]] = -1;
+    }
+    next_.clear();
+    cell_.clear();
+    overflow_.clear();
+    limit_ = 0;
+    count_ = 0;
+    minCellX_ = minCellY_ = numeric_limits<int>::max();
+    maxCellX_ = maxCellY_ = -1;
+}
+
+/**
+* reserves room for nodes with ids below capacity, so inserting them does not allocate
+*/
+void NodeGrid::reserve(int capacity)
+{
+    next_.reserve(capacity);
+    cell_.reserve(capacity);
+}
+
+/**
+* number of node ids that can be inserted without allocating
+*/
+int NodeGrid::capacity() const
+{
+    return (int)min(next_.capacity(), cell_.capacity());
+}
+
+/**
+* returns the bucket containing the given point, -1 if it lies outside the grid
+* Points on the far border belong to the last bucket, so the grid covers its
+* whole configured area including the upper edge of the map.
+*/
+int NodeGrid::cellOf(double X, double Y) const
+{
+    if(X < originX_ || Y < originY_ || X > originX_ + cellsX_ * cellSize_ || Y > originY_ + cellsY_ * cellSize_)
+        return -1;
+    int cx = min(int((X - originX_) / cellSize_), cellsX_ - 1);
+    int cy = min(int((Y - originY_) / cellSize_), cellsY_ - 1);
+    return cy * cellsX_ + cx;
+}
+
+/**
+* adds a node at the given position to the grid, or moves it if it is
+* already indexed
+* The node becomes visible to concurrent queries only once it is fully
+* linked, see the class comment.
+*/
+void NodeGrid::insert(int nodeID, double X, double Y)
+{
+    if(nodeID >= (int)cell_.size())
+    {
+        next_.resize(nodeID + 1, -1);
+        cell_.resize(nodeID + 1, -2);
+    }
+    if(cell_[nodeID] != -2)
+        unlink(nodeID);
+    else
+        store(count_, count_ + 1);
+
+    int cell = cellOf(X, Y);
+    cell_[nodeID] = cell;
+    if(cell >= 0)
+    {
+        int cx = cell % cellsX_, cy = cell / cellsX_;
+        store(minCellX_, min(minCellX_, cx));
+        store(maxCellX_, max(maxCellX_, cx));
+        store(minCellY_, min(minCellY_, cy));
+        store(maxCellY_, max(maxCellY_, cy));
+        next_[nodeID] = head_[cell];
+        __atomic_store_n(&head_[cell], nodeID, __ATOMIC_RELEASE);
+    }
+    else
+        overflow_.push_back(nodeID);
+    if(nodeID >= limit_)
+        __atomic_store_n(&limit_, nodeID + 1, __ATOMIC_RELEASE);
+}
+
+/**
+* updates the position of an indexed node
+*/
+void NodeGrid::move(int nodeID, double X, double Y)
+{
+    insert(nodeID, X, Y);
+}
+
+/**
+* removes a node from the grid; ids of other nodes are not affected
+*/
+void NodeGrid::remove(int nodeID)
+{
+    if(nodeID < 0 || nodeID >= (int)cell_.size() || cell_[nodeID] == -2)
+        return;
+    unlink(nodeID);
+    cell_[nodeID] = -2;
+    count_--;
+}
+
+void NodeGrid::unlink(int nodeID)
+{
+    int cell = cell_[nodeID];
+    if(cell < 0)
+    {
+        overflow_.erase(std::find(overflow_.begin(), overflow_.end(), nodeID));
+        return;
+    }
+    int *link = &head_[cell];
+    while(*link != nodeID)
+        link = &next_[*link];
+    *link = next_[nodeID];
+}
+
+void NodeGrid::scanCell(int cell, double X, double Y, const double *posX, const double *posY,
+                        double &bestDist, int &bestID) const
+{
+    for(int i=head(cell); i>=0; i=next_[i])
+    {
+        double dx = posX[i] - X, dy = posY[i] - Y;
+        double d = dx*dx + dy*dy;
+        if(d < bestDist || (d == bestDist && i < bestID))
+        {
+            bestDist = d;
+            bestID = i;
+        }
+    }
+}
+
+/**
+* return the indexed node nearest to the given point
+* @param posX, posY coordinate arrays indexed by node id
+* Rings of buckets are visited outwards from the query until the ring can no
+* longer contain anything closer than the best node found so far.
+* @return nodeID of the nearest node, -1 if the grid is empty
+*/
+int NodeGrid::nearest(double X, double Y, const double *posX, const double *posY) const
+{
+    int bestID = -1;
+    double bestDist = numeric_limits<double>::max();
+    for(size_t i=0; i<overflow_.size(); i++)
+    {
+        int id = overflow_[i];
+        double dx = posX[id] - X, dy = posY[id] - Y;
+        double d = dx*dx + dy*dy;
+        if(d < bestDist || (d == bestDist && id < bestID))
+        {
+            bestDist = d;
+            bestID = id;
+        }
+    }
+    int count = load(count_);
+    if(count == (int)overflow_.size())
+        return bestID;
+    int minCellX = load(minCellX_), maxCellX = load(maxCellX_), minCellY = load(minCellY_), maxCellY = load(maxCellY_);
+
+    // distances to the grid are bounded from below through the projection of
+    // the query onto the covered area, which also handles queries outside it
+    double px = min(max(X, originX_), originX_ + cellsX_ * cellSize_);
+    double py = min(max(Y, originY_), originY_ + cellsY_ * cellSize_);
+    int cx = min(int((px - originX_) / cellSize_), cellsX_ - 1);
+    int cy = min(int((py - originY_) / cellSize_), cellsY_ - 1);
+    double edge = min(min(px - (originX_ + cx * cellSize_), originX_ + (cx + 1) * cellSize_ - px),
+                      min(py - (originY_ + cy * cellSize_), originY_ + (cy + 1) * cellSize_ - py));
+
+    // rings are clipped to the bounding box of occupied buckets; once more
+    // buckets were visited than there are nodes a plain scan is cheaper
+    int visited = 0;
+    for(int k=0; ; k++)
+    {
+        if(k > 0 && bestID >= 0)
+        {
+            double bound = (k - 1) * cellSize_ + edge;
+            if(bound * bound > bestDist)
+                break;
+        }
+        int x0 = cx - k, x1 = cx + k, y0 = cy - k, y1 = cy + k;
+        for(int y=max(y0, minCellY); y<=min(y1, maxCellY); y++)
+        {
+            if(y == y0 || y == y1)
+            {
+                for(int x=max(x0, minCellX); x<=min(x1, maxCellX); x++)
+                    scanCell(y * cellsX_ + x, X, Y, posX, posY, bestDist, bestID);
+                visited += max(0, min(x1, maxCellX) - max(x0, minCellX) + 1);
+            }
+            else
+            {
+                if(x0 >= minCellX)
+                    scanCell(y * cellsX_ + x0, X, Y, posX, posY, bestDist, bestID);
+                if(x1 <= maxCellX)
+                    scanCell(y * cellsX_ + x1, X, Y, posX, posY, bestDist, bestID);
+                visited += 2;
+            }
+        }
+        if(x0 <= minCellX && x1 >= maxCellX && y0 <= minCellY && y1 >= maxCellY)
+            break;
+        if(visited > count)
+        {
+            int limit = __atomic_load_n(&limit_, __ATOMIC_ACQUIRE);
+            for(int i=0; i<limit; i++)
+            {
+                if(cell_[i] >= 0)
+                {
+                    double dx = posX[i] - X, dy = posY[i] - Y;
+                    double d = dx*dx + dy*dy;
+                    if(d < bestDist || (d == bestDist && i < bestID))
+                    {
+                        bestDist = d;
+                        bestID = i;
+                    }
+                }
+            }
+            break;
+        }
+    }
+    return bestID;
+}
+
+/**
+* collects every indexed node within distance r of the given point
+* @param posX, posY coordinate arrays indexed by node id
+* @param result filled with the node ids in ascending order
+*/
+void NodeGrid::radius(double X, double Y, double r, const double *posX, const double *posY,
+                      vector<int> &result) const
+{
+    result.clear();
+    double r2 = r * r;
+    for(size_t i=0; i<overflow_.size(); i++)
+    {
+        int id = overflow_[i];
+        double dx = posX[id] - X, dy = posY[id] - Y;
+        if(dx*dx + dy*dy <= r2)
+            result.push_back(id);
+    }
+    if(cellsX_ > 0)
+    {
+        int x0 = max(0, int(floor((X - r - originX_) / cellSize_)));
+        int x1 = min(cellsX_ - 1, int(floor((X + r - originX_) / cellSize_)));
+        int y0 = max(0, int(floor((Y - r - originY_) / cellSize_)));
+        int y1 = min(cellsY_ - 1, int(floor((Y + r - originY_) / cellSize_)));
+        for(int y=y0; y<=y1; y++)
+        {
+            for(int x=x0; x<=x1; x++)
+            {
+                for(int i=head(y * cellsX_ + x); i>=0; i=next_[i])
+                {
+                    double dx = posX[i] - X, dy = posY[i] - Y;
+                    if(dx*dx + dy*dy <= r2)
+                        result.push_back(i);
+                }
+            }
+        }
+    }
+    sort(result.begin(), result.end());
+}
+
+/**
+* returns the number of indexed nodes
+*/
+int NodeGrid::size() const
+{
+    return load(count_);
+}
+
+/**
+* collects the k indexed nodes nearest to the given point
+* Same ring search as nearest(), keeping the k best candidates in a heap
+* and stopping once a ring cannot beat the farthest of them.
+* @param posX, posY coordinate arrays indexed by node id
+* @param result filled with at most k node ids in ascending order
+*/
+void NodeGrid::nearestK(double X, double Y, int k, const double *posX, const double *posY,
+                        vector<int> &result) const
+{
+    result.clear();
+    if(k <= 0)
+        return;
+    FartherFirst order = {posX, posY, X, Y};
+    for(size_t i=0; i<overflow_.size(); i++)
+        offerK(result, k, overflow_[i], order);
+
+    int count = load(count_);
+    if(count > (int)overflow_.size())
+    {
+        int minCellX = load(minCellX_), maxCellX = load(maxCellX_), minCellY = load(minCellY_), maxCellY = load(maxCellY_);
+        double px = min(max(X, originX_), originX_ + cellsX_ * cellSize_);
+        double py = min(max(Y, originY_), originY_ + cellsY_ * cellSize_);
+        int cx = min(int((px - originX_) / cellSize_), cellsX_ - 1);
+        int cy = min(int((py - originY_) / cellSize_), cellsY_ - 1);
+        double edge = min(min(px - (originX_ + cx * cellSize_), originX_ + (cx + 1) * cellSize_ - px),
+                          min(py - (originY_ + cy * cellSize_), originY_ + (cy + 1) * cellSize_ - py));
+
+        int visited = 0;
+        for(int ring=0; ; ring++)
+        {
+            if(ring > 0 && (int)result.size() == k)
+            {
+                double bound = (ring - 1) * cellSize_ + edge;
+                if(bound * bound > order.dist(result.front()))
+                    break;
+            }
+            int x0 = cx - ring, x1 = cx + ring, y0 = cy - ring, y1 = cy + ring;
+            for(int y=max(y0, minCellY); y<=min(y1, maxCellY); y++)
+            {
+                if(y == y0 || y == y1)
+                {
+                    for(int x=max(x0, minCellX); x<=min(x1, maxCellX); x++)
+                    {
+                        for(int i=head(y * cellsX_ + x); i>=0; i=next_[i])
+                            offerK(result, k, i, order);
+                    }
+                    visited += max(0, min(x1, maxCellX) - max(x0, minCellX) + 1);
+                }
+                else
+                {
+                    if(x0 >= minCellX)
+                    {
+                        for(int i=head(y * cellsX_ + x0); i>=0; i=next_[i])
+                            offerK(result, k, i, order);
+                    }
+                    if(x1 <= maxCellX)
+                    {
+                        for(int i=head(y * cellsX_ + x1); i>=0; i=next_[i])
+                            offerK(result, k, i, order);
+                    }
+                    visited += 2;
+                }
+            }
+            if(x0 <= minCellX && x1 >= maxCellX && y0 <= minCellY && y1 >= maxCellY)
+                break;
+            if(visited > count)
+            {
+                result.clear();
+                int limit = __atomic_load_n(&limit_, __ATOMIC_ACQUIRE);
+                for(int i=0; i<limit; i++)
+                {
+                    if(cell_[i] != -2)
+                        offerK(result, k, i, order);
+                }
+                break;
+            }
+        }
+    }
+    sort(result.begin(), result.end());
+}
+
+}
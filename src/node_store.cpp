@@ -0,0 +1,311 @@
+#include <rrt_star_planner/node_store.h>
+#include <cmath>
+#include <algorithm>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+NodeStore::NodeStore()
+    : size_(0)
+{
+
+}
+
+/**
+* appends a node to the store and links it to its parent
+* @param parentID parent of the new node, the node's own id makes it a root
+* @return id of the new node
+*/
+int NodeStore::add(double X, double Y, int parentID, double cost)
+{
+    int id = size();
+    posX_.push_back(X);
+    posY_.push_back(Y);
+    cost_.push_back(cost);
+    parent_.push_back(parentID);
+    firstChild_.push_back(-1);
+    nextSibling_.push_back(-1);
+    prevSibling_.push_back(-1);
+    childCount_.push_back(0);
+    linkChild(id);
+    grid_.insert(id, X, Y);
+    setSize(id + 1);
+    return id;
+}
+
+/**
+* removes the most recently added node, which must not have children
+*/
+void NodeStore::popBack()
+{
+    int id = size() - 1;
+    unlinkChild(id);
+    grid_.remove(id);
+    posX_.pop_back();
+    posY_.pop_back();
+    cost_.pop_back();
+    parent_.pop_back();
+    firstChild_.pop_back();
+    nextSibling_.pop_back();
+    prevSibling_.pop_back();
+    childCount_.pop_back();
+    setSize(id);
+}
+
+/**
+* removes an arbitrary node; its children are handed to its parent and
+* every id above the removed one shifts down by one
+*/
+void NodeStore::erase(int nodeID)
+{
+    int up = parent_[nodeID] == nodeID ? -1 : parent_[nodeID];
+    for(int i=0; i<size(); i++)
+    {
+        if(i != nodeID && parent_[i] == nodeID)
+            parent_[i] = up < 0 ? i : up;
+    }
+    posX_.erase(posX_.begin() + nodeID);
+    posY_.erase(posY_.begin() + nodeID);
+    cost_.erase(cost_.begin() + nodeID);
+    parent_.erase(parent_.begin() + nodeID);
+    setSize(posX_.size());
+    for(int i=0; i<size(); i++)
+    {
+        if(parent_[i] > nodeID)
+            parent_[i]--;
+    }
+    firstChild_.pop_back();
+    nextSibling_.pop_back();
+    prevSibling_.pop_back();
+    childCount_.pop_back();
+    rebuildLinks();
+
+    grid_.clear();
+    for(int i=0; i<size(); i++)
+        grid_.insert(i, posX_[i], posY_[i]);
+}
+
+/**
+* drops every node that is no longer connected to the root (node 0), e.g.
+* detached subtrees, and renumbers the others breadth first from the root
+* @param newID filled with the new id of every old node, -1 for dropped ones
+* @return number of nodes dropped
+*/
+int NodeStore::prune(vector<int> &newID)
+{
+    int n = size();
+    newID.assign(n, -1);
+    if(n == 0)
+        return 0;
+    vector<int> order;
+    order.reserve(n);
+    order.push_back(0);
+    newID[0] = 0;
+    for(int i=0; i<order.size(); i++)
+    {
+        for(int c=firstChild_[order[i]]; c>=0; c=nextSibling_[c])
+        {
+            newID[c] = order.size();
+            order.push_back(c);
+        }
+    }
+
+    int m = order.size();
+    vector<double> oldX(posX_), oldY(posY_), oldCost(cost_);
+    vector<int> oldParent(parent_);
+    posX_.resize(m);
+    posY_.resize(m);
+    cost_.resize(m);
+    parent_.resize(m);
+    firstChild_.resize(m);
+    nextSibling_.resize(m);
+    prevSibling_.resize(m);
+    childCount_.resize(m);
+    setSize(m);
+    for(int i=0; i<m; i++)
+    {
+        int node = order[i];
+        posX_[i] = oldX[node];
+        posY_[i] = oldY[node];
+        cost_[i] = oldCost[node];
+        parent_[i] = i == 0 ? 0 : newID[oldParent[node]];
+    }
+    rebuildLinks();
+
+    grid_.clear();
+    for(int i=0; i<m; i++)
+        grid_.insert(i, posX_[i], posY_[i]);
+    return n - m;
+}
+
+/**
+* removes every node while keeping the allocated capacity
+*/
+void NodeStore::clear()
+{
+    posX_.clear();
+    posY_.clear();
+    cost_.clear();
+    parent_.clear();
+    firstChild_.clear();
+    nextSibling_.clear();
+    prevSibling_.clear();
+    childCount_.clear();
+    grid_.clear();
+    setSize(0);
+}
+
+/**
+* reserves room for capacity nodes in every array and in the spatial index
+* Together with clear() keeping the capacity, the store acts as an arena
+* that is reset between plans: adding nodes up to the reserved count never
+* allocates.
+*/
+void NodeStore::reserve(int capacity)
+{
+    posX_.reserve(capacity);
+    posY_.reserve(capacity);
+    cost_.reserve(capacity);
+    parent_.reserve(capacity);
+    firstChild_.reserve(capacity);
+    nextSibling_.reserve(capacity);
+    prevSibling_.reserve(capacity);
+    childCount_.reserve(capacity);
+    grid_.reserve(capacity);
+}
+
+/**
+* number of nodes the store holds before adding one allocates, i.e. before
+* an append may move the arrays that concurrent readers use
+*/
+int NodeStore::capacity() const
+{
+    size_t n = min(min(min(posX_.capacity(), posY_.capacity()), min(cost_.capacity(), parent_.capacity())),
+                   min(min(firstChild_.capacity(), nextSibling_.capacity()), min(prevSibling_.capacity(), childCount_.capacity())));
+    return min((int)n, grid_.capacity());
+}
+
+/**
+* sets the area covered by the spatial index and re-indexes the stored nodes
+*/
+void NodeStore::configureIndex(double originX, double originY, double sizeX, double sizeY, double cellSize)
+{
+    grid_.configure(originX, originY, sizeX, sizeY, cellSize);
+    for(int i=0; i<size(); i++)
+        grid_.insert(i, posX_[i], posY_[i]);
+}
+
+/**
+* @return id of the node nearest to the given point, -1 if the store is empty
+*/
+int NodeStore::nearest(double X, double Y) const
+{
+    return grid_.nearest(X, Y, posX_.data(), posY_.data());
+}
+
+/**
+* collects the ids of every node within distance r of the given point
+*/
+void NodeStore::radius(double X, double Y, double r, vector<int> &result) const
+{
+    grid_.radius(X, Y, r, posX_.data(), posY_.data(), result);
+}
+
+/**
+* collects the ids of the k nodes nearest to the given point
+*/
+void NodeStore::nearestK(double X, double Y, int k, vector<int> &result) const
+{
+    grid_.nearestK(X, Y, k, posX_.data(), posY_.data(), result);
+}
+
+void NodeStore::setPos(int nodeID, double X, double Y)
+{
+    posX_[nodeID] = X;
+    posY_[nodeID] = Y;
+    grid_.move(nodeID, X, Y);
+}
+
+/**
+* moves a node under a new parent, keeping the children lists consistent
+*/
+void NodeStore::setParent(int nodeID, int parentID)
+{
+    if(parent_[nodeID] == parentID)
+        return;
+    unlinkChild(nodeID);
+    parent_[nodeID] = parentID;
+    linkChild(nodeID);
+}
+
+/**
+* recomputes the cost of every descendant of a node from its parent's cost
+* plus the edge length, after the node's own cost has changed
+* Walks the subtree in preorder through the child and sibling links, climbing
+* back up through the parents, so it needs neither recursion nor a stack.
+* @return number of nodes updated
+*/
+int NodeStore::updateSubtreeCost(int nodeID)
+{
+    int count = 0;
+    int node = firstChild_[nodeID];
+    while(node >= 0)
+    {
+        int p = parent_[node];
+        double dx = posX_[node] - posX_[p], dy = posY_[node] - posY_[p];
+        setCost(node, cost_[p] + sqrt(dx * dx + dy * dy));
+        count++;
+
+        if(firstChild_[node] >= 0)
+        {
+            node = firstChild_[node];
+            continue;
+        }
+        while(node != nodeID && nextSibling_[node] < 0)
+            node = parent_[node];
+        node = node == nodeID ? -1 : nextSibling_[node];
+    }
+    return count;
+}
+
+void NodeStore::linkChild(int nodeID)
+{
+    int p = parent_[nodeID];
+    if(p == nodeID || p < 0)
+        return;
+    prevSibling_[nodeID] = -1;
+    nextSibling_[nodeID] = firstChild_[p];
+    if(firstChild_[p] >= 0)
+        prevSibling_[firstChild_[p]] = nodeID;
+    firstChild_[p] = nodeID;
+    childCount_[p]++;
+}
+
+void NodeStore::unlinkChild(int nodeID)
+{
+    int p = parent_[nodeID];
+    if(p == nodeID || p < 0)
+        return;
+    if(prevSibling_[nodeID] >= 0)
+        nextSibling_[prevSibling_[nodeID]] = nextSibling_[nodeID];
+    else
+        firstChild_[p] = nextSibling_[nodeID];
+    if(nextSibling_[nodeID] >= 0)
+        prevSibling_[nextSibling_[nodeID]] = prevSibling_[nodeID];
+    nextSibling_[nodeID] = prevSibling_[nodeID] = -1;
+    childCount_[p]--;
+}
+
+void NodeStore::rebuildLinks()
+{
+    for(int i=0; i<size(); i++)
+    {
+        firstChild_[i] = nextSibling_[i] = prevSibling_[i] = -1;
+        childCount_[i] = 0;
+    }
+    for(int i=size()-1; i>=0; i--)
+        linkChild(i);
+}
+
+}
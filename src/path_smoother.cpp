@@ -0,0 +1,182 @@
+#include <rrt_star_planner/path_smoother.h>
+#include <algorithm>
+#include <cmath>
+
+namespace rrtstar_planner{
+
+using namespace std;
+
+PathSmoother::PathSmoother()
+    : checker_(NULL), shortcutIterations_(100), collinearTolerance_(0.01), resolution_(0)
+{
+
+}
+
+/**
+* @param shortcutIterations number of random shortcut attempts, 0 to only do the greedy pass
+* @param collinearTolerance distance from the line through its neighbours below which a waypoint is dropped
+* @param resolution spacing of the resampled waypoints in meters, 0 to keep only the corners
+* @param capacity waypoints reserved in the caller's path arrays, the same is reserved here
+*/
+void PathSmoother::configure(int shortcutIterations, double collinearTolerance, double resolution, int capacity)
+{
+    shortcutIterations_ = shortcutIterations;
+    collinearTolerance_ = collinearTolerance;
+    resolution_ = resolution;
+    outX_.reserve(capacity);
+    outY_.reserve(capacity);
+    arcLength_.reserve(capacity);
+}
+
+/**
+* shortens the path in place; the first and the last waypoint stay where they are
+*/
+void PathSmoother::smooth(vector<double> &pathX, vector<double> &pathY, Sampler &sampler)
+{
+    if(pathX.size() < 2)
+        return;
+    shortcutGreedy(pathX, pathY);
+    shortcutRandom(pathX, pathY, sampler);
+    removeCollinear(pathX, pathY);
+    resample(pathX, pathY);
+}
+
+double PathSmoother::length(const vector<double> &pathX, const vector<double> &pathY)
+{
+    double sum = 0;
+    for(size_t i=1; i<pathX.size(); i++)
+        sum += hypot(pathX[i] - pathX[i-1], pathY[i] - pathY[i-1]);
+    return sum;
+}
+
+bool PathSmoother::edgeFree(double startX, double startY, double endX, double endY) const
+{
+    return checker_ == NULL || checker_->segmentFree(startX, startY, endX, endY);
+}
+
+/**
+* connects every kept waypoint straight to the farthest following waypoint
+* reachable without a collision, skipping everything in between
+*/
+void PathSmoother::shortcutGreedy(vector<double> &pathX, vector<double> &pathY)
+{
+    int n = pathX.size();
+    outX_.clear();
+    outY_.clear();
+    outX_.push_back(pathX[0]);
+    outY_.push_back(pathY[0]);
+    int i = 0;
+    while(i < n - 1)
+    {
+        int j = i + 1;
+        while(j + 1 < n && edgeFree(pathX[i], pathY[i], pathX[j+1], pathY[j+1]))
+            j++;
+        outX_.push_back(pathX[j]);
+        outY_.push_back(pathY[j]);
+        i = j;
+    }
+    pathX.swap(outX_);
+    pathY.swap(outY_);
+}
+
+/**
+* picks two random points along the path and, if they lie on different
+* segments and see each other, replaces the part between them by a straight edge
+*/
+void PathSmoother::shortcutRandom(vector<double> &pathX, vector<double> &pathY, Sampler &sampler)
+{
+    for(int it=0; it<shortcutIterations_; it++)
+    {
+        int n = pathX.size();
+        if(n < 3)
+            return;
+        arcLength_.resize(n);
+        arcLength_[0] = 0;
+        for(int k=1; k<n; k++)
+            arcLength_[k] = arcLength_[k-1] + hypot(pathX[k] - pathX[k-1], pathY[k] - pathY[k-1]);
+
+        double s1 = sampler.uniform() * arcLength_[n-1], s2 = sampler.uniform() * arcLength_[n-1];
+        if(s1 > s2)
+            swap(s1, s2);
+        int a = min(int(upper_bound(arcLength_.begin(), arcLength_.end(), s1) - arcLength_.begin()) - 1, n - 2);
+        int b = min(int(upper_bound(arcLength_.begin(), arcLength_.end(), s2) - arcLength_.begin()) - 1, n - 2);
+        if(a >= b)
+            continue;
+
+        double lengthA = arcLength_[a+1] - arcLength_[a], lengthB = arcLength_[b+1] - arcLength_[b];
+        double ta = lengthA > 0 ? (s1 - arcLength_[a]) / lengthA : 0;
+        double tb = lengthB > 0 ? (s2 - arcLength_[b]) / lengthB : 0;
+        double x1 = pathX[a] + ta * (pathX[a+1] - pathX[a]), y1 = pathY[a] + ta * (pathY[a+1] - pathY[a]);
+        double x2 = pathX[b] + tb * (pathX[b+1] - pathX[b]), y2 = pathY[b] + tb * (pathY[b+1] - pathY[b]);
+        if(!edgeFree(x1, y1, x2, y2))
+            continue;
+
+        outX_.assign(pathX.begin(), pathX.begin() + a + 1);
+        outY_.assign(pathY.begin(), pathY.begin() + a + 1);
+        outX_.push_back(x1);
+        outY_.push_back(y1);
+        outX_.push_back(x2);
+        outY_.push_back(y2);
+        outX_.insert(outX_.end(), pathX.begin() + b + 1, pathX.end());
+        outY_.insert(outY_.end(), pathY.begin() + b + 1, pathY.end());
+        pathX.swap(outX_);
+        pathY.swap(outY_);
+    }
+}
+
+/**
+* drops waypoints closer than the tolerance to the edge between the previous
+* kept waypoint and the next one, if that edge is free
+*/
+void PathSmoother::removeCollinear(vector<double> &pathX, vector<double> &pathY)
+{
+    int n = pathX.size();
+    outX_.clear();
+    outY_.clear();
+    outX_.push_back(pathX[0]);
+    outY_.push_back(pathY[0]);
+    for(int k=1; k<n-1; k++)
+    {
+        double ax = outX_.back(), ay = outY_.back();
+        double cx = pathX[k+1] - ax, cy = pathY[k+1] - ay;
+        double bx = pathX[k] - ax, by = pathY[k] - ay;
+        double base = hypot(cx, cy);
+        if(base > 0 && fabs(cx * by - cy * bx) / base <= collinearTolerance_ &&
+           edgeFree(ax, ay, pathX[k+1], pathY[k+1]))
+            continue;
+        outX_.push_back(pathX[k]);
+        outY_.push_back(pathY[k]);
+    }
+    outX_.push_back(pathX[n-1]);
+    outY_.push_back(pathY[n-1]);
+    pathX.swap(outX_);
+    pathY.swap(outY_);
+}
+
+/**
+* splits every segment into equal pieces no longer than the resolution
+*/
+void PathSmoother::resample(vector<double> &pathX, vector<double> &pathY)
+{
+    if(resolution_ <= 0)
+        return;
+    int n = pathX.size();
+    outX_.clear();
+    outY_.clear();
+    outX_.push_back(pathX[0]);
+    outY_.push_back(pathY[0]);
+    for(int k=1; k<n; k++)
+    {
+        double dx = pathX[k] - pathX[k-1], dy = pathY[k] - pathY[k-1];
+        int pieces = max(1, int(ceil(hypot(dx, dy) / resolution_)));
+        for(int s=1; s<=pieces; s++)
+        {
+            outX_.push_back(pathX[k-1] + dx * s / pieces);
+            outY_.push_back(pathY[k-1] + dy * s / pieces);
+        }
+    }
+    pathX.swap(outX_);
+    pathY.swap(outY_);
+}
+
+}
@@ -0,0 +1,53 @@
+#include <rrt_star_planner/plan_profiler.h>
+
+namespace rrtstar_planner{
+
+static const char *PHASE_NAMES[PlanProfiler::PHASE_COUNT] =
+    { "other", "sampling", "nearest", "collision", "choose_parent", "rewire", "visualization", "repair", "snapshot", "roadmap" };
+static const char *COUNTER_NAMES[PlanProfiler::COUNTER_COUNT] =
+    { "samples_drawn", "samples_rejected", "collision_checks", "rewires", "nodes_added",
+      "edges_invalidated", "nodes_reconnected", "nodes_dropped" };
+
+/**
+* clears all phases and counters and starts the clock in the OTHER phase
+*/
+void PlanProfiler::reset()
+{
+    for(int i=0; i<PHASE_COUNT; i++)
+        phaseNs_[i] = 0;
+    for(int i=0; i<COUNTER_COUNT; i++)
+        counters_[i] = 0;
+    current_ = OTHER;
+    mark_ = now();
+}
+
+/**
+* charges the time since the last phase change to the current phase
+*/
+void PlanProfiler::finish()
+{
+    enter(current_);
+}
+
+/**
+* adds the phases and counters of another profiler, e.g. of a parallel worker
+*/
+void PlanProfiler::merge(const PlanProfiler &other)
+{
+    for(int i=0; i<PHASE_COUNT; i++)
+        phaseNs_[i] += other.phaseNs_[i];
+    for(int i=0; i<COUNTER_COUNT; i++)
+        counters_[i] += other.counters_[i];
+}
+
+const char *PlanProfiler::phaseName(Phase phase)
+{
+    return PHASE_NAMES[phase];
+}
+
+const char *PlanProfiler::counterName(Counter counter)
+{
+    return COUNTER_NAMES[counter];
+}
+
+}
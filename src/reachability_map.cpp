@@ -0,0 +1,127 @@
+#include <rrt_star_planner/reachability_map.h>
+#include <algorithm>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+ReachabilityMap::ReachabilityMap()
+    : factor_(4), sizeX_(0), sizeY_(0), cellsX_(0), cellsY_(0), originX_(0), originY_(0), cellSize_(1.0)
+{
+
+}
+
+/**
+* @param factor edge length of a coarse cell in costmap cells
+*/
+void ReachabilityMap::setDownsample(int factor)
+{
+    factor_ = max(1, factor);
+    free_.clear();
+}
+
+/**
+* rebuilds the coarse free mask from the map snapshot and relabels the components if it changed
+* @return true if the components were recomputed
+*/
+bool ReachabilityMap::update(const CostmapSnapshot &map)
+{
+    unsigned int sx = map.getSizeInCellsX(), sy = map.getSizeInCellsY();
+    int cellsX = (sx + factor_ - 1) / factor_, cellsY = (sy + factor_ - 1) / factor_;
+
+    //整字全为障碍时跳过，只逐个检查含空闲栅格的字
+    mask_.assign(cellsX * cellsY, 0);
+    for(unsigned int y=0; y<sy; y++)
+    {
+        const uint64_t* row = map.row(y);
+        unsigned char* coarse = &mask_[(y / factor_) * cellsX];
+        for(unsigned int w=0; w * 64 < sx; w++)
+        {
+            uint64_t open = ~row[w];
+            while(open)
+            {
+                unsigned int x = w * 64 + __builtin_ctzll(open);
+                if(x >= sx)
+                    break;
+                coarse[x / factor_] = 1;
+                open &= open - 1;
+            }
+        }
+    }
+
+    bool moved = sx != sizeX_ || sy != sizeY_ || map.getOriginX() != originX_ ||
+                 map.getOriginY() != originY_ || map.getResolution() * factor_ != cellSize_;
+    if(!moved && mask_ == free_)
+        return false;
+
+    sizeX_ = sx;
+    sizeY_ = sy;
+    cellsX_ = cellsX;
+    cellsY_ = cellsY;
+    originX_ = map.getOriginX();
+    originY_ = map.getOriginY();
+    cellSize_ = map.getResolution() * factor_;
+    free_.swap(mask_);
+    label();
+    return true;
+}
+
+/**
+* flood fills the 8-connected components of the free coarse cells
+*/
+void ReachabilityMap::label()
+{
+    label_.assign(free_.size(), -1);
+    queue_.resize(free_.size());
+    int components = 0;
+    for(int seed=0; seed<(int)free_.size(); seed++)
+    {
+        if(!free_[seed] || label_[seed] >= 0)
+            continue;
+        int head = 0, tail = 0;
+        queue_[tail++] = seed;
+        label_[seed] = components;
+        while(head < tail)
+        {
+            int cell = queue_[head++];
+            int cx = cell % cellsX_, cy = cell / cellsX_;
+            for(int y=max(cy - 1, 0); y<=min(cy + 1, cellsY_ - 1); y++)
+            {
+                for(int x=max(cx - 1, 0); x<=min(cx + 1, cellsX_ - 1); x++)
+                {
+                    int next = y * cellsX_ + x;
+                    if(free_[next] && label_[next] < 0)
+                    {
+                        label_[next] = components;
+                        queue_[tail++] = next;
+                    }
+                }
+            }
+        }
+        components++;
+    }
+}
+
+/**
+* @return component of the coarse cell containing the point, -1 if it is blocked or off the map
+*/
+int ReachabilityMap::component(double X, double Y) const
+{
+    if(X < originX_ || Y < originY_)
+        return -1;
+    int cx = int((X - originX_) / cellSize_), cy = int((Y - originY_) / cellSize_);
+    if(cx >= cellsX_ || cy >= cellsY_)
+        return -1;
+    return label_[cy * cellsX_ + cx];
+}
+
+/**
+* false if the two points certainly cannot be joined by a collision-free path
+*/
+bool ReachabilityMap::connected(double startX, double startY, double goalX, double goalY) const
+{
+    int start = component(startX, startY);
+    return start >= 0 && start == component(goalX, goalY);
+}
+
+}
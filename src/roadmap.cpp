@@ -0,0 +1,266 @@
+#include <rrt_star_planner/roadmap.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+Roadmap::Roadmap()
+    : radius_(0.5), maxDegree_(10), generation_(0)
+{
+
+}
+
+/**
+* @param radius nodes farther apart than this are never joined directly
+* @param maxDegree nearest nodes a new node or query point tries to link to
+*/
+void Roadmap::configure(double radius, int maxDegree)
+{
+    radius_ = radius;
+    maxDegree_ = max(1, maxDegree);
+}
+
+void Roadmap::setBounds(double originX, double originY, double sizeX, double sizeY)
+{
+    nodes_.configureIndex(originX, originY, sizeX, sizeY, radius_);
+}
+
+void Roadmap::clear()
+{
+    nodes_.clear();
+    edgeHead_.clear();
+    edgeTo_.clear();
+    edgeNext_.clear();
+    edgeLength_.clear();
+    visit_.clear();
+    goalHead_.clear();
+    generation_ = 0;
+}
+
+void Roadmap::reserve(int capacity)
+{
+    nodes_.reserve(capacity);
+    edgeHead_.reserve(capacity);
+    edgeTo_.reserve(2 * maxDegree_ * capacity);
+    edgeNext_.reserve(2 * maxDegree_ * capacity);
+    edgeLength_.reserve(2 * maxDegree_ * capacity);
+}
+
+void Roadmap::addEdge(int a, int b, double length)
+{
+    edgeTo_.push_back(b);
+    edgeLength_.push_back(length);
+    edgeNext_.push_back(edgeHead_[a]);
+    edgeHead_[a] = edgeTo_.size() - 1;
+    edgeTo_.push_back(a);
+    edgeLength_.push_back(length);
+    edgeNext_.push_back(edgeHead_[b]);
+    edgeHead_[b] = edgeTo_.size() - 1;
+}
+
+/**
+* fills candidates_ with the at most maxDegree nodes nearest to the point
+* within the connection radius, nearest first
+*/
+void Roadmap::nearestCandidates(double X, double Y, int excludeID)
+{
+    nodes_.radius(X, Y, radius_, candidates_);
+    candidates_.erase(remove(candidates_.begin(), candidates_.end(), excludeID), candidates_.end());
+    auto nearer = [&](int l, int r)
+    {
+        return hypot(nodes_.x(l) - X, nodes_.y(l) - Y) < hypot(nodes_.x(r) - X, nodes_.y(r) - Y);
+    };
+    if((int)candidates_.size() > maxDegree_)
+    {
+        nth_element(candidates_.begin(), candidates_.begin() + maxDegree_, candidates_.end(), nearer);
+        candidates_.resize(maxDegree_);
+    }
+    sort(candidates_.begin(), candidates_.end(), nearer);
+}
+
+/**
+* adds a free point to the roadmap and joins it to its nearest visible nodes
+* @return id of the new node, -1 if the point is not free
+*/
+int Roadmap::addNode(double X, double Y, const CollisionChecker &checker)
+{
+    if(!checker.pointFree(X, Y))
+        return -1;
+    nearestCandidates(X, Y, -1);
+    int id = nodes_.add(X, Y, nodes_.size(), 0);
+    edgeHead_.push_back(-1);
+    for(int i=0; i<candidates_.size(); i++)
+    {
+        int c = candidates_[i];
+        if(checker.segmentFree(nodes_.x(c), nodes_.y(c), X, Y))
+            addEdge(id, c, hypot(nodes_.x(c) - X, nodes_.y(c) - Y));
+    }
+    return id;
+}
+
+/**
+* links a query point to its nearest visible roadmap nodes without adding it
+* If no node lies within the connection radius, the nearest nodes at any
+* distance are tried.
+* @return false if the point itself is not free
+*/
+bool Roadmap::connect(double X, double Y, const CollisionChecker &checker, Terminal &terminal)
+{
+    terminal.x = X;
+    terminal.y = Y;
+    terminal.nodes.clear();
+    terminal.lengths.clear();
+    if(!checker.pointFree(X, Y))
+        return false;
+    nearestCandidates(X, Y, -1);
+    if(candidates_.empty())
+    {
+        nodes_.nearestK(X, Y, maxDegree_, candidates_);
+        sort(candidates_.begin(), candidates_.end(), [&](int l, int r)
+        {
+            return hypot(nodes_.x(l) - X, nodes_.y(l) - Y) < hypot(nodes_.x(r) - X, nodes_.y(r) - Y);
+        });
+    }
+    for(int i=0; i<candidates_.size(); i++)
+    {
+        int c = candidates_[i];
+        if(checker.segmentFree(nodes_.x(c), nodes_.y(c), X, Y))
+        {
+            terminal.nodes.push_back(c);
+            terminal.lengths.push_back(hypot(nodes_.x(c) - X, nodes_.y(c) - Y));
+        }
+    }
+    return true;
+}
+
+/**
+* Dijkstra from the start terminal until no goal can get cheaper
+* Leaves the cost of each goal in goalCost_ (infinite if unreachable), the
+* node it was reached through in goalVia_ and the search tree in prev_.
+* A free straight edge between start and goal is also considered.
+*/
+void Roadmap::search(const Terminal &start, const Terminal *goals, int count, const CollisionChecker &checker)
+{
+    const double INF = numeric_limits<double>::infinity();
+    int n = nodes_.size();
+    if(++generation_ == 0)
+    {
+        visit_.assign(n, 0);
+        generation_ = 1;
+    }
+    visit_.resize(n, 0);
+    dist_.resize(n);
+    prev_.resize(n);
+    goalHead_.resize(n, -1);
+
+    //目标点挂到它连接的路图节点上，搜索到这些节点时更新目标的代价
+    goalCost_.assign(count, INF);
+    goalVia_.assign(count, -1);
+    goalIndex_.clear();
+    goalNext_.clear();
+    goalLength_.clear();
+    for(int j=0; j<count; j++)
+    {
+        const Terminal &goal = goals[j];
+        for(int k=0; k<goal.nodes.size(); k++)
+        {
+            goalIndex_.push_back(j);
+            goalLength_.push_back(goal.lengths[k]);
+            goalNext_.push_back(goalHead_[goal.nodes[k]]);
+            goalHead_[goal.nodes[k]] = goalIndex_.size() - 1;
+        }
+        if(checker.segmentFree(start.x, start.y, goal.x, goal.y))
+            goalCost_[j] = hypot(goal.x - start.x, goal.y - start.y);
+    }
+    double bound = count > 0 ? *max_element(goalCost_.begin(), goalCost_.end()) : 0.0;
+
+    heap_.clear();
+    for(int k=0; k<start.nodes.size(); k++)
+    {
+        int node = start.nodes[k];
+        if(visit_[node] == generation_ && dist_[node] <= start.lengths[k])
+            continue;
+        visit_[node] = generation_;
+        dist_[node] = start.lengths[k];
+        prev_[node] = -1;
+        Entry entry = { start.lengths[k], node };
+        heap_.push_back(entry);
+        push_heap(heap_.begin(), heap_.end());
+    }
+
+    //所有目标的代价都不会再降低时停止
+    while(!heap_.empty())
+    {
+        pop_heap(heap_.begin(), heap_.end());
+        Entry best = heap_.back();
+        heap_.pop_back();
+        if(best.cost > dist_[best.node])
+            continue;
+        if(best.cost >= bound)
+            break;
+
+        bool improved = false;
+        for(int g=goalHead_[best.node]; g>=0; g=goalNext_[g])
+        {
+            int j = goalIndex_[g];
+            double via = best.cost + goalLength_[g];
+            if(via < goalCost_[j])
+            {
+                goalCost_[j] = via;
+                goalVia_[j] = best.node;
+                improved = true;
+            }
+        }
+        if(improved)
+            bound = *max_element(goalCost_.begin(), goalCost_.end());
+
+        for(int e=edgeHead_[best.node]; e>=0; e=edgeNext_[e])
+        {
+            int next = edgeTo_[e];
+            double via = best.cost + edgeLength_[e];
+            if(visit_[next] == generation_ && dist_[next] <= via)
+                continue;
+            visit_[next] = generation_;
+            dist_[next] = via;
+            prev_[next] = best.node;
+            Entry entry = { via, next };
+            heap_.push_back(entry);
+            push_heap(heap_.begin(), heap_.end());
+        }
+    }
+
+    for(int j=0; j<count; j++)
+        for(int k=0; k<goals[j].nodes.size(); k++)
+            goalHead_[goals[j].nodes[k]] = -1;
+}
+
+/**
+* shortest roadmap distance from one start to each goal, infinity where no path exists
+*/
+void Roadmap::costs(const Terminal &start, const std::vector<Terminal> &goals, const CollisionChecker &checker,
+                    std::vector<double> &result)
+{
+    search(start, goals.data(), goals.size(), checker);
+    result = goalCost_;
+}
+
+/**
+* shortest roadmap path between two terminals
+* @param nodes roadmap nodes strictly between start and goal, empty for the direct edge
+* @return length of the path, infinity if there is none
+*/
+double Roadmap::path(const Terminal &start, const Terminal &goal, const CollisionChecker &checker,
+                     std::vector<int> &nodes)
+{
+    search(start, &goal, 1, checker);
+    nodes.clear();
+    for(int node=goalVia_[0]; node>=0; node=prev_[node])
+        nodes.push_back(node);
+    reverse(nodes.begin(), nodes.end());
+    return goalCost_[0];
+}
+
+}
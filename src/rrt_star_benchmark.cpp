@@ -0,0 +1,1068 @@
+/**
+* Headless benchmark for the RRT* planner core.
+*
+* Runs RRT::makePlan on synthetic or map_server maps over a fixed set of
+* start/goal pairs and fixed seeds, without a ROS master, and writes one
+* record per plan as CSV or JSON.
+*
+* usage: rrt_star_benchmark [options]
+*   --map <file.yaml>        map_server map (PGM image), may be repeated
+*   --maze <cells>           synthetic maze with cells x cells corridors
+*   --forest <size>          size x size cells with random round obstacles
+*   --wall <size>            size x size cells with a wall and one gap
+*   --queries <n>            start/goal pairs per map (default 5)
+*   --seeds <n>              random seeds per pair (default 3)
+*   --param <name>=<value>   planner parameter, may be repeated
+*   --sweep <name>=<v1,v2..> run everything once per value, e.g.
+*                            planner_threads=1,2,4, use_distance_field=true,false
+*                            or bidirectional=false,true; the summary then gives
+*                            each value's iteration throughput as a multiple of
+*                            the first value's, i.e. the speedup curve for
+*                            planner_threads=1,2,4,8
+*   --format csv|json        output format (default csv)
+*   --output <file>          output file (default stdout)
+*   --check-allocations <n>  instead of benchmarking, check that the planning
+*                            loop does not allocate: a warmed-up planner must
+*                            make no heap allocation inside the single-threaded
+*                            loop of plans of n and 3n iterations; exits with 1
+*                            otherwise. Runs as a test of the package.
+*   --origin <x>,<y>         move the origin of every map to (x, y) meters
+*   --check-boundary <n>     instead of benchmarking, check that plans of n
+*                            iterations accept starts and goals up to the far
+*                            edge of every map and reject points just off each
+*                            side as invalid; exits with 1 otherwise. Runs as a
+*                            test of the package with positive and negative
+*                            origins.
+*   --edge-benchmark <n>     instead of benchmarking plans, time the edge check
+*                            CollisionChecker::segmentFree against the original
+*                            per-point test stepped along the edge at half a
+*                            cell, on the same n random edges per map and
+*                            length class
+*   --save-trees <dir>       write the tree of every plan to
+*                            <dir>/<scenario>_<config>_<query>_<seed>.rrt
+*   --diff-trees <a>,<b>     instead of benchmarking, compare two tree
+*                            snapshots; exits with 1 if they differ
+*   --replay <file.rrt>      instead of benchmarking, plan again from the root
+*                            to the goal of a tree snapshot with its seed on the
+*                            scenario of the same map size, write the new tree
+*                            to <file.rrt>.replay and compare the two; exits
+*                            with 1 if they differ. The same --param options
+*                            as for the original run must be given. Only plans
+*                            limited by max_iterations rather than time, with
+*                            planner_threads=1 and no tree reuse, replay exactly
+* A summary per scenario and configuration (success rate, mean time to first
+* solution, planning time and path cost) is printed to stderr at the end.
+* Without any map option the maze, forest and wall scenarios are used.
+* Plans run in anytime mode with a 0.5 s budget unless --param overrides it.
+*/
+#include <rrt_star_planner/rrtstarplan.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+#include <sys/resource.h>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <new>
+
+using namespace std;
+using namespace rrtstar_planner;
+using costmap_2d::FREE_SPACE;
+using costmap_2d::LETHAL_OBSTACLE;
+using costmap_2d::NO_INFORMATION;
+
+// every heap allocation in the process is counted, so each record can report the allocations of its plan
+static std::atomic<long> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationCount++;
+    void *memory = malloc(size ? size : 1);
+    if(!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+struct Query
+{
+    double startX, startY, goalX, goalY;
+};
+
+struct Scenario
+{
+    string name;
+    boost::shared_ptr<costmap_2d::Costmap2D> costmap;
+    vector<Query> queries;
+};
+
+struct Record
+{
+    string scenario, config;
+    int query, seed;
+    RRT::PlanStatistics stats;
+    long peakRssKB;
+    long allocations;
+    int waypoints;
+};
+
+/**
+* reads a binary (P5) or ASCII (P2) PGM image
+*/
+static bool readPGM(const string &path, int &width, int &height, vector<int> &pixels)
+{
+    ifstream in(path.c_str(), ios::binary);
+    if(!in)
+        return false;
+    string magic;
+    in >> magic;
+    if(magic != "P5" && magic != "P2")
+        return false;
+
+    int header[3], count = 0;
+    while(count < 3 && in)
+    {
+        in >> ws;
+        if(in.peek() == '#')
+        {
+            string comment;
+            getline(in, comment);
+            continue;
+        }
+        in >> header[count++];
+    }
+    width = header[0];
+    height = header[1];
+    int maxValue = header[2];
+    if(!in || width <= 0 || height <= 0 || maxValue <= 0 || maxValue > 255)
+        return false;
+
+    pixels.resize(width * height);
+    if(magic == "P5")
+    {
+        in.get();
+        vector<unsigned char> raw(width * height);
+        in.read((char*)raw.data(), raw.size());
+        for(int i=0; i<raw.size(); i++)
+            pixels[i] = raw[i] * 255 / maxValue;
+    }
+    else
+    {
+        for(int i=0; i<pixels.size(); i++)
+        {
+            in >> pixels[i];
+            pixels[i] = pixels[i] * 255 / maxValue;
+        }
+    }
+    return bool(in);
+}
+
+/**
+* loads a map_server map description and its image into a costmap
+* Cells are thresholded the way map_server does in trinary mode.
+*/
+static bool loadMap(const string &yamlPath, costmap_2d::Costmap2D &costmap)
+{
+    ifstream in(yamlPath.c_str());
+    if(!in)
+        return false;
+    string image, line;
+    double resolution = 0, originX = 0, originY = 0, occupiedThresh = 0.65, freeThresh = 0.196;
+    int negate = 0;
+    while(getline(in, line))
+    {
+        size_t colon = line.find(':');
+        if(colon == string::npos)
+            continue;
+        string key = line.substr(0, colon), value = line.substr(colon + 1);
+        key.erase(0, key.find_first_not_of(" \t"));
+        value.erase(0, value.find_first_not_of(" \t"));
+        if(key == "image")
+            image = value;
+        else if(key == "resolution")
+            resolution = atof(value.c_str());
+        else if(key == "negate")
+            negate = atoi(value.c_str());
+        else if(key == "occupied_thresh")
+            occupiedThresh = atof(value.c_str());
+        else if(key == "free_thresh")
+            freeThresh = atof(value.c_str());
+        else if(key == "origin")
+        {
+            for(int i=0; i<value.size(); i++)
+            {
+                if(value[i] == '[' || value[i] == ']' || value[i] == ',')
+                    value[i] = ' ';
+            }
+            istringstream origin(value);
+            origin >> originX >> originY;
+        }
+    }
+    if(image.empty() || resolution <= 0)
+        return false;
+    if(image[0] == '"' || image[0] == '\'')
+        image = image.substr(1, image.size() - 2);
+    if(image[0] != '/' && yamlPath.find('/') != string::npos)
+        image = yamlPath.substr(0, yamlPath.rfind('/') + 1) + image;
+
+    int width, height;
+    vector<int> pixels;
+    if(!readPGM(image, width, height, pixels))
+        return false;
+
+    costmap.resizeMap(width, height, resolution, originX, originY);
+    for(int row=0; row<height; row++)
+    {
+        for(int col=0; col<width; col++)
+        {
+            int pixel = pixels[row * width + col];
+            double occupancy = negate ? pixel / 255.0 : (255 - pixel) / 255.0;
+            unsigned char cost = occupancy > occupiedThresh ? LETHAL_OBSTACLE :
+                                 occupancy < freeThresh ? FREE_SPACE : NO_INFORMATION;
+            // image rows run top down, costmap rows bottom up
+            costmap.setCost(col, height - 1 - row, cost);
+        }
+    }
+    return true;
+}
+
+static void fill(costmap_2d::Costmap2D &costmap, int x0, int y0, int x1, int y1, unsigned char cost)
+{
+    for(int y=max(y0, 0); y<min(y1, int(costmap.getSizeInCellsY())); y++)
+        for(int x=max(x0, 0); x<min(x1, int(costmap.getSizeInCellsX())); x++)
+            costmap.setCost(x, y, cost);
+}
+
+/**
+* perfect maze from a depth-first backtracker: corridors 8 cells wide, walls 2 cells thick
+*/
+static void makeMaze(costmap_2d::Costmap2D &costmap, int cells, unsigned int seed)
+{
+    const int corridor = 8, wall = 2, pitch = corridor + wall;
+    int size = cells * pitch + wall;
+    costmap.resizeMap(size, size, 0.05, 0, 0);
+    fill(costmap, 0, 0, size, size, LETHAL_OBSTACLE);
+
+    mt19937 rng(seed);
+    vector<char> visited(cells * cells, 0);
+    vector<int> stack(1, 0);
+    visited[0] = 1;
+    fill(costmap, wall, wall, wall + corridor, wall + corridor, FREE_SPACE);
+    while(!stack.empty())
+    {
+        int cell = stack.back(), cx = cell % cells, cy = cell / cells;
+        int next[4], count = 0;
+        const int dx[4] = {1, -1, 0, 0}, dy[4] = {0, 0, 1, -1};
+        for(int d=0; d<4; d++)
+        {
+            int nx = cx + dx[d], ny = cy + dy[d];
+            if(nx >= 0 && ny >= 0 && nx < cells && ny < cells && !visited[ny * cells + nx])
+                next[count++] = ny * cells + nx;
+        }
+        if(count == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+        int chosen = next[rng() % count], nx = chosen % cells, ny = chosen / cells;
+        visited[chosen] = 1;
+        stack.push_back(chosen);
+        // open the chosen cell and the wall between the two cells
+        int x0 = min(cx, nx) * pitch + wall, y0 = min(cy, ny) * pitch + wall;
+        int x1 = max(cx, nx) * pitch + wall + corridor, y1 = max(cy, ny) * pitch + wall + corridor;
+        fill(costmap, x0, y0, x1, y1, FREE_SPACE);
+    }
+}
+
+static void makeForest(costmap_2d::Costmap2D &costmap, int size, unsigned int seed)
+{
+    costmap.resizeMap(size, size, 0.05, 0, 0);
+    fill(costmap, 0, 0, size, size, FREE_SPACE);
+    mt19937 rng(seed);
+    int trees = size * size / 800;
+    for(int i=0; i<trees; i++)
+    {
+        int cx = rng() % size, cy = rng() % size, r = 2 + rng() % 6;
+        for(int y=cy-r; y<=cy+r; y++)
+            for(int x=cx-r; x<=cx+r; x++)
+                if((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r)
+                    fill(costmap, x, y, x + 1, y + 1, LETHAL_OBSTACLE);
+    }
+}
+
+static void makeWall(costmap_2d::Costmap2D &costmap, int size)
+{
+    costmap.resizeMap(size, size, 0.05, 0, 0);
+    fill(costmap, 0, 0, size, size, FREE_SPACE);
+    fill(costmap, size / 2, 0, size / 2 + 2, size * 3 / 4, LETHAL_OBSTACLE);
+}
+
+/**
+* true if every cell within margin cells of (mx, my) is free
+*/
+static bool clearAround(const costmap_2d::Costmap2D &costmap, int mx, int my, int margin)
+{
+    for(int y=my-margin; y<=my+margin; y++)
+    {
+        for(int x=mx-margin; x<=mx+margin; x++)
+        {
+            if(x < 0 || y < 0 || x >= costmap.getSizeInCellsX() || y >= costmap.getSizeInCellsY() ||
+               costmap.getCost(x, y) != FREE_SPACE)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+* draws start/goal pairs on free cells, at least 40% of the map diagonal apart
+*/
+static vector<Query> makeQueries(const costmap_2d::Costmap2D &costmap, int count, unsigned int seed)
+{
+    mt19937 rng(seed);
+    vector<Query> queries;
+    int sx = costmap.getSizeInCellsX(), sy = costmap.getSizeInCellsY();
+    double minDist = 0.4 * hypot(sx, sy) * costmap.getResolution();
+    for(int attempt=0; queries.size() < count && attempt < 100000; attempt++)
+    {
+        int ax = rng() % sx, ay = rng() % sy, bx = rng() % sx, by = rng() % sy;
+        if(!clearAround(costmap, ax, ay, 2) || !clearAround(costmap, bx, by, 2))
+            continue;
+        Query q;
+        costmap.mapToWorld(ax, ay, q.startX, q.startY);
+        costmap.mapToWorld(bx, by, q.goalX, q.goalY);
+        if(hypot(q.goalX - q.startX, q.goalY - q.startY) >= minDist)
+            queries.push_back(q);
+    }
+    return queries;
+}
+
+static long peakRssKB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static geometry_msgs::PoseStamped makePose(double x, double y)
+{
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation.w = 1.0;
+    return pose;
+}
+
+static void writeCSV(ostream &out, const vector<Record> &records)
+{
+    out << "scenario,config,query,seed,success,failure_reason,iterations,iterations_per_s,first_solution_s,"
+           "planning_s,path_cost,raw_path_cost,waypoints,nodes,peak_rss_kb,allocations";
+    for(int p=0; p<PlanProfiler::PHASE_COUNT; p++)
+        out << ',' << PlanProfiler::phaseName(PlanProfiler::Phase(p)) << "_s";
+    for(int c=0; c<PlanProfiler::COUNTER_COUNT; c++)
+        out << ',' << PlanProfiler::counterName(PlanProfiler::Counter(c));
+    out << '\n';
+    for(int i=0; i<records.size(); i++)
+    {
+        const Record &r = records[i];
+        const RRT::PlanStatistics &s = r.stats;
+        out << r.scenario << ',' << r.config << ',' << r.query << ',' << r.seed << ',' << s.pathFound << ','
+            << RRT::PlanStatistics::failureReasonName(s.failureReason) << ',' << s.iterations << ','
+            << (s.planningTime > 0 ? s.iterations / s.planningTime : 0) << ','
+            << s.firstSolutionTime << ',' << s.planningTime << ',' << s.pathCost << ','
+            << s.rawPathCost << ',' << r.waypoints << ',' << s.nodes << ',' << r.peakRssKB << ',' << r.allocations;
+        for(int p=0; p<PlanProfiler::PHASE_COUNT; p++)
+            out << ',' << s.profile.phaseTime(PlanProfiler::Phase(p));
+        for(int c=0; c<PlanProfiler::COUNTER_COUNT; c++)
+            out << ',' << s.profile.counter(PlanProfiler::Counter(c));
+        out << '\n';
+    }
+}
+
+static void writeJSON(ostream &out, const vector<Record> &records)
+{
+    out << "[\n";
+    for(int i=0; i<records.size(); i++)
+    {
+        const Record &r = records[i];
+        const RRT::PlanStatistics &s = r.stats;
+        out << "  {\"scenario\": \"" << r.scenario << "\", \"config\": \"" << r.config
+            << "\", \"query\": " << r.query << ", \"seed\": " << r.seed
+            << ", \"success\": " << (s.pathFound ? "true" : "false")
+            << ", \"failure_reason\": \"" << RRT::PlanStatistics::failureReasonName(s.failureReason) << "\""
+            << ", \"iterations\": " << s.iterations
+            << ", \"iterations_per_s\": " << (s.planningTime > 0 ? s.iterations / s.planningTime : 0)
+            << ", \"first_solution_s\": " << s.firstSolutionTime
+            << ", \"planning_s\": " << s.planningTime
+            << ", \"path_cost\": " << s.pathCost
+            << ", \"raw_path_cost\": " << s.rawPathCost
+            << ", \"waypoints\": " << r.waypoints
+            << ", \"nodes\": " << s.nodes
+            << ", \"peak_rss_kb\": " << r.peakRssKB
+            << ", \"allocations\": " << r.allocations;
+        for(int p=0; p<PlanProfiler::PHASE_COUNT; p++)
+            out << ", \"" << PlanProfiler::phaseName(PlanProfiler::Phase(p)) << "_s\": " << s.profile.phaseTime(PlanProfiler::Phase(p));
+        for(int c=0; c<PlanProfiler::COUNTER_COUNT; c++)
+            out << ", \"" << PlanProfiler::counterName(PlanProfiler::Counter(c)) << "\": " << s.profile.counter(PlanProfiler::Counter(c));
+        out << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+/**
+* one line per scenario and configuration: success rate and means over the
+* successful plans, e.g. to compare time to first solution across a sweep
+*/
+static void writeSummary(ostream &out, const vector<Record> &records)
+{
+    vector<string> keys, configs;
+    for(int i=0; i<records.size(); i++)
+    {
+        string key = records[i].scenario + " " + records[i].config;
+        if(find(keys.begin(), keys.end(), key) == keys.end())
+            keys.push_back(key);
+        if(find(configs.begin(), configs.end(), records[i].config) == configs.end())
+            configs.push_back(records[i].config);
+    }
+    map<string, double> throughput;
+    for(int k=0; k<keys.size(); k++)
+    {
+        int runs = 0, solved = 0;
+        double firstSolution = 0, planning = 0, cost = 0, iterations = 0, time = 0;
+        string scenario;
+        for(int i=0; i<records.size(); i++)
+        {
+            const Record &r = records[i];
+            if(r.scenario + " " + r.config != keys[k])
+                continue;
+            scenario = r.scenario;
+            runs++;
+            iterations += r.stats.iterations;
+            time += r.stats.planningTime;
+            if(!r.stats.pathFound)
+                continue;
+            solved++;
+            firstSolution += r.stats.firstSolutionTime;
+            planning += r.stats.planningTime;
+            cost += r.stats.pathCost;
+        }
+        throughput[keys[k]] = time > 0 ? iterations / time : 0;
+        out << keys[k] << ": solved " << solved << "/" << runs;
+        if(solved > 0)
+            out << ", mean first solution " << firstSolution / solved << " s, mean planning " << planning / solved
+                << " s, mean path cost " << cost / solved;
+        out << ", " << long(throughput[keys[k]]) << " iterations/s";
+        // 扫描参数时，迭代吞吐量相对第一个取值的倍数，例如planner_threads的加速曲线
+        double base = throughput[scenario + " " + configs[0]];
+        if(configs.size() > 1 && base > 0)
+            out << " (" << throughput[keys[k]] / base << "x " << configs[0] << ")";
+        out << endl;
+    }
+}
+
+static void usage()
+{
+    cerr << "usage: rrt_star_benchmark [--map file.yaml] [--maze cells] [--forest size] [--wall size]\n"
+            "                          [--queries n] [--seeds n] [--param name=value] [--sweep name=v1,v2]\n"
+            "                          [--format csv|json] [--output file] [--check-allocations n]\n"
+            "                          [--save-trees dir] [--diff-trees a.rrt,b.rrt] [--replay file.rrt]\n"
+            "                          [--edge-benchmark n] [--origin x,y] [--check-boundary n]\n";
+}
+
+/**
+* moves the origin of a map without moving its cells
+*/
+static void setOrigin(costmap_2d::Costmap2D &costmap, double originX, double originY)
+{
+    unsigned int sx = costmap.getSizeInCellsX(), sy = costmap.getSizeInCellsY();
+    vector<unsigned char> cells(costmap.getCharMap(), costmap.getCharMap() + sx * sy);
+    costmap.resizeMap(sx, sy, costmap.getResolution(), originX, originY);
+    copy(cells.begin(), cells.end(), costmap.getCharMap());
+}
+
+/**
+* plans from the first query's start to the free cell nearest the far corner
+* of every scenario, and to points half a cell off each side of the map
+* @return true if the far corner is never rejected as invalid and every
+* off-map goal is
+*/
+static bool checkBoundary(const vector<Scenario> &scenarios, const vector<pair<string, string> > &params, int iterations)
+{
+    bool passed = true;
+    for(int sc=0; sc<scenarios.size(); sc++)
+    {
+        const costmap_2d::Costmap2D &costmap = *scenarios[sc].costmap;
+        RRT planner;
+        planner.setParameter("visualize", "false");
+        planner.setParameter("max_planning_time", "1000");
+        for(int p=0; p<params.size(); p++)
+            planner.setParameter(params[p].first, params[p].second);
+        ostringstream iterationValue;
+        iterationValue << iterations;
+        planner.setParameter("max_iterations", iterationValue.str());
+        planner.setParameter("random_seed", "1");
+        planner.initialize("benchmark", scenarios[sc].costmap.get(), "map");
+
+        //离原点最远的角附近找一个四周都空闲的栅格
+        int sx = costmap.getSizeInCellsX(), sy = costmap.getSizeInCellsY(), farX = -1, farY = -1;
+        for(int d=1; d<min(sx, sy) && farX < 0; d++)
+        {
+            for(int k=1; k<=d && farX < 0; k++)
+            {
+                if(clearAround(costmap, sx - 1 - k, sy - 1 - d, 1))
+                    farX = sx - 1 - k, farY = sy - 1 - d;
+                else if(clearAround(costmap, sx - 1 - d, sy - 1 - k, 1))
+                    farX = sx - 1 - d, farY = sy - 1 - k;
+            }
+        }
+        const Query &query = scenarios[sc].queries[0];
+        vector<geometry_msgs::PoseStamped> plan;
+        if(farX >= 0)
+        {
+            double x, y;
+            costmap.mapToWorld(farX, farY, x, y);
+            planner.makePlan(makePose(query.startX, query.startY), makePose(x, y), plan);
+            RRT::PlanStatistics::FailureReason reason = planner.getPlanStatistics().failureReason;
+            bool ok = reason != RRT::PlanStatistics::INVALID_START && reason != RRT::PlanStatistics::INVALID_GOAL;
+            cout << scenarios[sc].name << ": goal at the far corner (" << x << ", " << y << ") "
+                 << (planner.getPlanStatistics().pathFound ? "solved" : RRT::PlanStatistics::failureReasonName(reason))
+                 << (ok ? "  ok" : "  FAILED") << endl;
+            passed = passed && ok;
+        }
+
+        double half = 0.5 * costmap.getResolution();
+        double minX = costmap.getOriginX(), minY = costmap.getOriginY();
+        double maxX = minX + sx * costmap.getResolution(), maxY = minY + sy * costmap.getResolution();
+        double offX[] = {minX - half, maxX + half, 0.5 * (minX + maxX), 0.5 * (minX + maxX)};
+        double offY[] = {0.5 * (minY + maxY), 0.5 * (minY + maxY), minY - half, maxY + half};
+        for(int i=0; i<4; i++)
+        {
+            planner.makePlan(makePose(query.startX, query.startY), makePose(offX[i], offY[i]), plan);
+            bool ok = planner.getPlanStatistics().failureReason == RRT::PlanStatistics::INVALID_GOAL;
+            cout << scenarios[sc].name << ": goal off the map (" << offX[i] << ", " << offY[i] << ") "
+                 << RRT::PlanStatistics::failureReasonName(planner.getPlanStatistics().failureReason)
+                 << (ok ? "  ok" : "  FAILED") << endl;
+            passed = passed && ok;
+        }
+    }
+    return passed;
+}
+
+/**
+* the planner's original point test: the cell under the point is FREE_SPACE or NO_INFORMATION
+*/
+static bool pointFreeBaseline(const costmap_2d::Costmap2D &costmap, double X, double Y)
+{
+    unsigned int gridx, gridy;
+    if(!costmap.worldToMap(X, Y, gridx, gridy))
+        return false;
+    unsigned char cost = costmap.getCharMap()[costmap.getIndex(gridx, gridy)];
+    return cost == FREE_SPACE || cost == NO_INFORMATION;
+}
+
+/**
+* an edge checked the way it was before segmentFree: the point test at
+* points half a cell apart from start to end
+*/
+static bool edgeFreeBaseline(const costmap_2d::Costmap2D &costmap, double startX, double startY, double endX, double endY)
+{
+    double length = hypot(endX - startX, endY - startY);
+    int steps = max(1, int(ceil(length / (0.5 * costmap.getResolution()))));
+    for(int s=0; s<=steps; s++)
+    {
+        if(!pointFreeBaseline(costmap, startX + (endX - startX) * s / steps, startY + (endY - startY) * s / steps))
+            return false;
+    }
+    return true;
+}
+
+/**
+* times segmentFree against edgeFreeBaseline on the same random edges of
+* each scenario, for edges up to the neighbor radius and up to 1 m long
+*/
+static void benchmarkEdges(const vector<Scenario> &scenarios, int count)
+{
+    const double maxLengths[] = {0.15, 1.0};
+    const int repeats = 5;
+    for(int sc=0; sc<scenarios.size(); sc++)
+    {
+        costmap_2d::Costmap2D &costmap = *scenarios[sc].costmap;
+        CostmapSnapshot snapshot;
+        snapshot.update(costmap);
+        CollisionChecker checker;
+        checker.setSnapshot(&snapshot);
+        double minX = costmap.getOriginX(), minY = costmap.getOriginY();
+        double maxX = minX + costmap.getSizeInMetersX(), maxY = minY + costmap.getSizeInMetersY();
+
+        for(int l=0; l<2; l++)
+        {
+            mt19937 rng(11);
+            uniform_real_distribution<double> unit(0.0, 1.0);
+            vector<double> edges;
+            edges.reserve(4 * count);
+            for(int i=0; i<count; i++)
+            {
+                double x = minX + 1e-3 + unit(rng) * (maxX - minX - 2e-3), y = minY + 1e-3 + unit(rng) * (maxY - minY - 2e-3);
+                double angle = 2 * M_PI * unit(rng), length = unit(rng) * maxLengths[l];
+                edges.push_back(x);
+                edges.push_back(y);
+                // ends are kept a millimetre inside the map so that rounding along the edge never steps off it
+                edges.push_back(min(max(x + length * cos(angle), minX + 1e-3), maxX - 1e-3));
+                edges.push_back(min(max(y + length * sin(angle), minY + 1e-3), maxY - 1e-3));
+            }
+
+            //两种检查在同一组边上各重复几遍，取总时间
+            long baselineFree = 0, segmentFree = 0, missed = 0, extra = 0;
+            uint64_t t0 = PlanProfiler::now();
+            for(int r=0; r<repeats; r++)
+                for(int i=0; i<count; i++)
+                    baselineFree += edgeFreeBaseline(costmap, edges[4*i], edges[4*i+1], edges[4*i+2], edges[4*i+3]);
+            uint64_t t1 = PlanProfiler::now();
+            for(int r=0; r<repeats; r++)
+                for(int i=0; i<count; i++)
+                    segmentFree += checker.segmentFree(edges[4*i], edges[4*i+1], edges[4*i+2], edges[4*i+3]);
+            uint64_t t2 = PlanProfiler::now();
+            //逐点检查会漏掉边只擦过角的栅格；反过来的情况说明segmentFree放过了障碍
+            for(int i=0; i<count; i++)
+            {
+                bool baseline = edgeFreeBaseline(costmap, edges[4*i], edges[4*i+1], edges[4*i+2], edges[4*i+3]);
+                bool segment = checker.segmentFree(edges[4*i], edges[4*i+1], edges[4*i+2], edges[4*i+3]);
+                missed += baseline && !segment;
+                extra += segment && !baseline;
+            }
+
+            double baselineNs = double(t1 - t0) / (repeats * count), segmentNs = double(t2 - t1) / (repeats * count);
+            printf("%s edges up to %.2f m: per-point %.1f ns/edge, segmentFree %.1f ns/edge, speedup %.2fx, "
+                   "%.1f%% free, %ld of %d blocked edges passed by the per-point test, %ld free edges rejected by it\n",
+                   scenarios[sc].name.c_str(), maxLengths[l], baselineNs, segmentNs, baselineNs / segmentNs,
+                   100.0 * segmentFree / (repeats * count), missed, count, extra);
+        }
+    }
+}
+
+/**
+* file name for the tree of one plan, with the characters of scenario and
+* configuration names that do not belong in file names replaced
+*/
+static string treeFileName(const string &dir, const Record &record)
+{
+    ostringstream name;
+    name << record.scenario << "_" << record.config << "_" << record.query << "_" << record.seed << ".rrt";
+    string file = name.str();
+    for(int i=0; i<file.size(); i++)
+    {
+        if(file[i] == ':' || file[i] == '=' || file[i] == '/' || file[i] == ',')
+            file[i] = '-';
+    }
+    return dir + "/" + file;
+}
+
+/**
+* prints the differences between two tree snapshots to out
+* @return true if both trees and what they were planned on are identical
+*/
+static bool diffTrees(const string &pathA, const string &pathB, ostream &out)
+{
+    TreeSnapshot a, b;
+    if(!a.open(pathA) || !b.open(pathB))
+    {
+        out << (a.isOpen() ? b.error() : a.error()) << endl;
+        return false;
+    }
+    const TreeSnapshot::Metadata &ma = a.metadata(), &mb = b.metadata();
+    bool same = true;
+    if(ma.resolution != mb.resolution || ma.originX != mb.originX || ma.originY != mb.originY ||
+       ma.sizeX != mb.sizeX || ma.sizeY != mb.sizeY)
+    {
+        out << "maps differ: " << ma.sizeX << "x" << ma.sizeY << " cells of " << ma.resolution << " m vs "
+            << mb.sizeX << "x" << mb.sizeY << " cells of " << mb.resolution << " m" << endl;
+        same = false;
+    }
+    if(ma.goalX != mb.goalX || ma.goalY != mb.goalY)
+    {
+        out << "goals differ: (" << ma.goalX << ", " << ma.goalY << ") vs (" << mb.goalX << ", " << mb.goalY << ")" << endl;
+        same = false;
+    }
+    if(ma.seed != mb.seed)
+    {
+        out << "seeds differ: " << ma.seed << " vs " << mb.seed << endl;
+        same = false;
+    }
+    if(a.size() != b.size())
+    {
+        out << "node counts differ: " << a.size() << " vs " << b.size() << endl;
+        same = false;
+    }
+
+    //逐个节点比较公共部分
+    int n = min(a.size(), b.size()), firstDiff = -1, moved = 0, reparented = 0;
+    double maxCostDiff = 0;
+    for(int i=0; i<n; i++)
+    {
+        bool differs = false;
+        if(a.x()[i] != b.x()[i] || a.y()[i] != b.y()[i])
+        {
+            moved++;
+            differs = true;
+        }
+        if(a.parent()[i] != b.parent()[i])
+        {
+            reparented++;
+            differs = true;
+        }
+        if(a.cost()[i] != b.cost()[i])
+        {
+            maxCostDiff = max(maxCostDiff, fabs(a.cost()[i] - b.cost()[i]));
+            differs = true;
+        }
+        if(differs && firstDiff < 0)
+            firstDiff = i;
+    }
+    if(firstDiff >= 0)
+    {
+        out << "first differing node " << firstDiff << ": (" << a.x()[firstDiff] << ", " << a.y()[firstDiff] << ") parent "
+            << a.parent()[firstDiff] << " vs (" << b.x()[firstDiff] << ", " << b.y()[firstDiff] << ") parent "
+            << b.parent()[firstDiff] << endl;
+        out << moved << " of " << n << " common nodes at different positions, " << reparented
+            << " with different parents, largest cost difference " << maxCostDiff << endl;
+        same = false;
+    }
+    if(same)
+        out << "trees are identical (" << a.size() << " nodes)" << endl;
+    return same;
+}
+
+/**
+* plans again what a tree snapshot recorded, on every scenario whose map has
+* the geometry of the snapshot, and compares the new tree with the recorded one
+* @return true if some scenario reproduces the tree exactly
+*/
+static bool replayTree(const string &path, const vector<Scenario> &scenarios, const vector<pair<string, string> > &params)
+{
+    TreeSnapshot snapshot;
+    if(!snapshot.open(path))
+    {
+        cerr << snapshot.error() << endl;
+        return false;
+    }
+    TreeSnapshot::Metadata metadata = snapshot.metadata();
+    double startX = snapshot.x()[0], startY = snapshot.y()[0];
+    snapshot.close();
+    if(metadata.seed > uint64_t(INT_MAX))
+    {
+        cerr << path << " was planned with a time-based seed and cannot be replayed" << endl;
+        return false;
+    }
+
+    bool reproduced = false, matched = false;
+    string replayPath = path + ".replay";
+    for(int sc=0; sc<scenarios.size() && !reproduced; sc++)
+    {
+        const costmap_2d::Costmap2D &costmap = *scenarios[sc].costmap;
+        if(costmap.getResolution() != metadata.resolution || costmap.getOriginX() != metadata.originX ||
+           costmap.getOriginY() != metadata.originY || costmap.getSizeInCellsX() != metadata.sizeX ||
+           costmap.getSizeInCellsY() != metadata.sizeY)
+            continue;
+        matched = true;
+
+        RRT planner;
+        planner.setParameter("visualize", "false");
+        planner.setParameter("anytime", "true");
+        planner.setParameter("max_planning_time", "0.5");
+        for(int p=0; p<params.size(); p++)
+            planner.setParameter(params[p].first, params[p].second);
+        ostringstream seedValue;
+        seedValue << metadata.seed;
+        planner.setParameter("random_seed", seedValue.str());
+        planner.initialize("benchmark", scenarios[sc].costmap.get(), "map");
+
+        vector<geometry_msgs::PoseStamped> plan;
+        planner.makePlan(makePose(startX, startY), makePose(metadata.goalX, metadata.goalY), plan);
+        if(!planner.saveTree(replayPath))
+        {
+            cerr << "cannot write " << replayPath << endl;
+            return false;
+        }
+        cout << scenarios[sc].name << ": ";
+        reproduced = diffTrees(path, replayPath, cout);
+    }
+    if(!matched)
+        cerr << "no scenario has the map of " << path << endl;
+    return reproduced;
+}
+
+/**
+* heap allocations inside the planning loop of one anytime plan of the given
+* number of iterations on the first query of a scenario, measured on the
+* second, identical plan so that every buffer has already grown to its
+* steady-state size; map updates before the loop and path post-processing
+* after it are not counted
+* @return -1 if the planner did not run its single-threaded loop
+*/
+static long allocationsInLoop(const Scenario &scenario, const vector<pair<string, string> > &params, int iterations)
+{
+    RRT planner;
+    planner.setParameter("visualize", "false");
+    planner.setParameter("anytime", "true");
+    planner.setParameter("max_planning_time", "1000");
+    for(int p=0; p<params.size(); p++)
+        planner.setParameter(params[p].first, params[p].second);
+    ostringstream iterationValue;
+    iterationValue << iterations;
+    planner.setParameter("max_iterations", iterationValue.str());
+    planner.setParameter("random_seed", "1");
+    planner.initialize("benchmark", scenario.costmap.get(), "map");
+
+    const Query &query = scenario.queries[0];
+    geometry_msgs::PoseStamped start = makePose(query.startX, query.startY), goal = makePose(query.goalX, query.goalY);
+    vector<geometry_msgs::PoseStamped> plan;
+    planner.makePlan(start, goal, plan);
+    long before = -1, inLoop = -1;
+    planner.setLoopHook([&](bool entering)
+    {
+        if(entering)
+            before = allocationCount;
+        else
+            inLoop = allocationCount - before;
+    });
+    planner.makePlan(start, goal, plan);
+    return inLoop;
+}
+
+int main(int argc, char** argv)
+{
+    vector<Scenario> scenarios;
+    vector<pair<string, string> > params;
+    string sweepName, format = "csv", output, treeDir, diffFiles, replayFile;
+    vector<string> sweepValues;
+    int queryCount = 5, seedCount = 3, checkIterations = 0, edgeCount = 0, boundaryIterations = 0;
+    bool moveOrigin = false;
+    double originX = 0, originY = 0;
+
+    for(int i=1; i<argc; i++)
+    {
+        string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if(arg == "--map" || arg == "--maze" || arg == "--forest" || arg == "--wall")
+        {
+            Scenario scenario;
+            scenario.costmap.reset(new costmap_2d::Costmap2D());
+            scenario.name = arg.substr(2) + ":" + value;
+            if(arg == "--map" && !loadMap(value, *scenario.costmap))
+            {
+                cerr << "cannot load map " << value << endl;
+                return 1;
+            }
+            if(arg == "--maze")
+                makeMaze(*scenario.costmap, atoi(value.c_str()), 1);
+            else if(arg == "--forest")
+                makeForest(*scenario.costmap, atoi(value.c_str()), 1);
+            else if(arg == "--wall")
+                makeWall(*scenario.costmap, atoi(value.c_str()));
+            scenarios.push_back(scenario);
+        }
+        else if(arg == "--queries")
+            queryCount = atoi(value.c_str());
+        else if(arg == "--seeds")
+            seedCount = atoi(value.c_str());
+        else if(arg == "--param" || arg == "--sweep")
+        {
+            size_t eq = value.find('=');
+            if(eq == string::npos)
+            {
+                usage();
+                return 1;
+            }
+            if(arg == "--param")
+                params.push_back(make_pair(value.substr(0, eq), value.substr(eq + 1)));
+            else
+            {
+                sweepName = value.substr(0, eq);
+                istringstream list(value.substr(eq + 1));
+                string item;
+                while(getline(list, item, ','))
+                    sweepValues.push_back(item);
+            }
+        }
+        else if(arg == "--format")
+            format = value;
+        else if(arg == "--output")
+            output = value;
+        else if(arg == "--check-allocations")
+            checkIterations = atoi(value.c_str());
+        else if(arg == "--origin")
+        {
+            if(sscanf(value.c_str(), "%lf,%lf", &originX, &originY) != 2)
+            {
+                usage();
+                return 1;
+            }
+            moveOrigin = true;
+        }
+        else if(arg == "--check-boundary")
+            boundaryIterations = atoi(value.c_str());
+        else if(arg == "--edge-benchmark")
+            edgeCount = atoi(value.c_str());
+        else if(arg == "--save-trees")
+            treeDir = value;
+        else if(arg == "--diff-trees")
+            diffFiles = value;
+        else if(arg == "--replay")
+            replayFile = value;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if(!diffFiles.empty())
+    {
+        size_t comma = diffFiles.find(',');
+        if(comma == string::npos)
+        {
+            usage();
+            return 1;
+        }
+        return diffTrees(diffFiles.substr(0, comma), diffFiles.substr(comma + 1), cout) ? 0 : 1;
+    }
+
+    if(scenarios.empty())
+    {
+        const char* names[] = {"maze:12", "forest:200", "wall:200"};
+        for(int i=0; i<3; i++)
+        {
+            Scenario scenario;
+            scenario.name = names[i];
+            scenario.costmap.reset(new costmap_2d::Costmap2D());
+            scenarios.push_back(scenario);
+        }
+        makeMaze(*scenarios[0].costmap, 12, 1);
+        makeForest(*scenarios[1].costmap, 200, 1);
+        makeWall(*scenarios[2].costmap, 200);
+    }
+    for(int i=0; i<scenarios.size(); i++)
+    {
+        if(moveOrigin)
+            setOrigin(*scenarios[i].costmap, originX, originY);
+        scenarios[i].queries = makeQueries(*scenarios[i].costmap, queryCount, 7);
+    }
+    if(sweepValues.empty())
+        sweepValues.push_back("");
+
+    // no ros::init: the planner takes its parameters from setParameter and needs no master
+    ros::Time::init();
+
+    if(checkIterations > 0)
+    {
+        // a warmed-up planning loop must not allocate at all, however long it runs
+        bool passed = true;
+        for(int sc=0; sc<scenarios.size(); sc++)
+        {
+            long shortPlan = allocationsInLoop(scenarios[sc], params, checkIterations);
+            long longPlan = allocationsInLoop(scenarios[sc], params, 3 * checkIterations);
+            bool ok = shortPlan == 0 && longPlan == 0;
+            if(shortPlan < 0 || longPlan < 0)
+                cout << scenarios[sc].name << ": the planner did not run its single-threaded loop  FAILED" << endl;
+            else
+                cout << scenarios[sc].name << ": " << shortPlan << " allocations in a loop of " << checkIterations << " iterations, "
+                     << longPlan << " in " << 3 * checkIterations << (ok ? "  ok" : "  FAILED") << endl;
+            passed = passed && ok;
+        }
+        return passed ? 0 : 1;
+    }
+    if(!replayFile.empty())
+        return replayTree(replayFile, scenarios, params) ? 0 : 1;
+    if(boundaryIterations > 0)
+        return checkBoundary(scenarios, params, boundaryIterations) ? 0 : 1;
+    if(edgeCount > 0)
+    {
+        benchmarkEdges(scenarios, edgeCount);
+        return 0;
+    }
+
+    vector<Record> records;
+    for(int v=0; v<sweepValues.size(); v++)
+    {
+        string config = sweepName.empty() ? "default" : sweepName + "=" + sweepValues[v];
+        for(int sc=0; sc<scenarios.size(); sc++)
+        {
+            Scenario &scenario = scenarios[sc];
+            for(int seed=0; seed<seedCount; seed++)
+            {
+                RRT planner;
+                planner.setParameter("visualize", "false");
+                planner.setParameter("anytime", "true");
+                planner.setParameter("max_planning_time", "0.5");
+                for(int p=0; p<params.size(); p++)
+                    planner.setParameter(params[p].first, params[p].second);
+                if(!sweepName.empty())
+                    planner.setParameter(sweepName, sweepValues[v]);
+                ostringstream seedValue;
+                seedValue << seed + 1;
+                planner.setParameter("random_seed", seedValue.str());
+                planner.initialize("benchmark", scenario.costmap.get(), "map");
+
+                for(int q=0; q<scenario.queries.size(); q++)
+                {
+                    const Query &query = scenario.queries[q];
+                    vector<geometry_msgs::PoseStamped> plan;
+                    if(q == 0)
+                    {
+                        // untimed warm-up so the first record does not include building the distance field
+                        planner.makePlan(makePose(query.startX, query.startY), makePose(query.goalX, query.goalY), plan);
+                    }
+                    long before = allocationCount;
+                    planner.makePlan(makePose(query.startX, query.startY), makePose(query.goalX, query.goalY), plan);
+
+                    Record record;
+                    record.allocations = allocationCount - before;
+                    record.waypoints = plan.size();
+                    record.scenario = scenario.name;
+                    record.config = config;
+                    record.query = q;
+                    record.seed = seed + 1;
+                    record.stats = planner.getPlanStatistics();
+                    record.peakRssKB = peakRssKB();
+                    records.push_back(record);
+                    if(!treeDir.empty() && planner.getTreeSize() > 0 && !planner.saveTree(treeFileName(treeDir, record)))
+                        cerr << "cannot write " << treeFileName(treeDir, record) << endl;
+                    cerr << record.scenario << " " << config << " query " << q << " seed " << seed + 1
+                         << (record.stats.pathFound ? " solved" : " failed") << " in " << record.stats.planningTime << " s" << endl;
+                }
+            }
+        }
+    }
+
+    ofstream file;
+    if(!output.empty())
+        file.open(output.c_str());
+    ostream &out = output.empty() ? cout : file;
+    if(format == "json")
+        writeJSON(out, records);
+    else
+        writeCSV(out, records);
+    writeSummary(cerr, records);
+    return 0;
+}
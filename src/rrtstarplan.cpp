@@ -1,7 +1,8 @@
 #include <ros/ros.h>
 #include <visualization_msgs/Marker.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <geometry_msgs/Point.h>
-#include "/home/alif/catkin_ws/src/rrt_star_planner/include/rrt_star_planner/rrtstarplan.h"
+#include <rrt_star_planner/rrtstarplan.h>
 #include <iostream>
 #include <cmath>
 #include <math.h>
@@ -13,10 +14,18 @@
 #include <Eigen/Dense>
 #include <cstdlib>
 #include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <boost/thread.hpp>
+#include <boost/scoped_array.hpp>
+#include <sstream>
 
 #define success false
 #define running true
 #define PI 3.1415926
+#define NEIGHBOR_RADIUS 0.15
+#define MAX_SAMPLE_ATTEMPTS 100
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(rrtstar_planner::RRT, nav_core::BaseGlobalPlanner)
@@ -28,30 +37,306 @@ namespace rrtstar_planner{
     using costmap_2d::NO_INFORMATION;
     using costmap_2d::FREE_SPACE;
 
+/**
+* ros::ok() for a node that called ros::init; always true when the planner
+* runs without ROS (e.g. in the benchmark)
+*/
+static inline bool rosOk()
+{
+    return !ros::isInitialized() || ros::ok();
+}
+
+double caldistance(double sourceX, double sourceY, double destinationX, double destinationY)
+{
+    return sqrt(pow(destinationX - sourceX,2) + pow(destinationY - sourceY,2));
+}
+
 RRT::RRT()
+    : initialized_(false), publishDiagnostics_(false), costmap_ros_(NULL), bidirectional_(false)
 {
 
 }
 
 RRT::RRT(std::string name, costmap_2d::Costmap2DROS* costmap_ros) 
+    : initialized_(false), publishDiagnostics_(false), costmap_ros_(NULL), bidirectional_(false)
 {
     initialize(name, costmap_ros);
 }
 
+RRT::RRT(std::string name, costmap_2d::Costmap2D* costmap, std::string global_frame)
+    : initialized_(false), publishDiagnostics_(false), costmap_ros_(NULL), bidirectional_(false)
+{
+    initialize(name, costmap, global_frame);
+}
+
+/**
+* overrides a planner parameter before initialize() is called
+* Overrides take precedence over the parameter server. Without ros::init
+* (e.g. in the benchmark) they and the defaults are the only source.
+*/
+void RRT::setParameter(const std::string &name, const std::string &value)
+{
+    paramOverrides_[name] = value;
+}
+
+template <class T>
+void RRT::loadParam(const ros::NodeHandle *nh, const std::string &name, T &value, const T &defaultValue)
+{
+    std::map<std::string, std::string>::const_iterator it = paramOverrides_.find(name);
+    if(it == paramOverrides_.end())
+    {
+        if(nh)
+            nh->param(name, value, defaultValue);
+        else
+            value = defaultValue;
+        return;
+    }
+    std::istringstream in(it->second);
+    if(!(in >> std::boolalpha >> value))
+    {
+        in.clear();
+        in.str(it->second);
+        in >> std::noboolalpha;
+        if(!(in >> value))
+            value = defaultValue;
+    }
+}
+
+template <>
+void RRT::loadParam(const ros::NodeHandle *nh, const std::string &name, std::string &value, const std::string &defaultValue)
+{
+    std::map<std::string, std::string>::const_iterator it = paramOverrides_.find(name);
+    if(it != paramOverrides_.end())
+        value = it->second;
+    else if(nh)
+        nh->param(name, value, defaultValue);
+    else
+        value = defaultValue;
+}
+
 void RRT::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
+{
+    if(!initialized_)
+    {
+        costmap_ros_ = costmap_ros; //initialize the costmap_ros_ attribute to the parameter.
+        footprint = costmap_ros_->getRobotFootprint();
+        initialize(name, costmap_ros_->getCostmap(), costmap_ros_->getGlobalFrameID());
+    }
+    else
+    {
+        ROS_WARN("This planner has already been initialized... doing nothing");
+    }
+}
+
+/**
+* initializes the planner on a bare costmap, without a Costmap2DROS (as navfn does)
+* @param global_frame frame of the costmap, used for the markers
+*/
+void RRT::initialize(std::string name, costmap_2d::Costmap2D* costmap, std::string global_frame)
     {
         if(!initialized_)
         {
-            costmap_ros_ = costmap_ros; //initialize the costmap_ros_ attribute to the parameter.
-            costmap_ = costmap_ros_->getCostmap(); //get the costmap_ from costmap_ros_
-            footprint = costmap_ros_->getRobotFootprint();
+            name_ = name;
+            costmap_ = costmap;
+            globalFrame_ = global_frame;
 
         // initialize other planner parameters
-        /*ros::NodeHandle private_nh("~/" + name);
-        private_nh.param("step_size", step_size_, costmap_->getResolution());
+            boost::shared_ptr<ros::NodeHandle> private_nh;
+            if(ros::isInitialized())
+                private_nh.reset(new ros::NodeHandle("~/" + name));
+        /*private_nh.param("step_size", step_size_, costmap_->getResolution());
         private_nh.param("min_dist_from_robot", min_dist_from_robot_, 0.10);*/
             world_model_ = new base_local_planner::CostmapModel(*costmap_);
 
+            //每次规划开始时在代价地图的锁内复制一份按位压缩的快照，之后的所有检查只读快照
+            loadParam(private_nh.get(), "snapshot_margin", snapshotMargin_, 0.0);
+            collisionChecker_.setSnapshot(&snapshot_);
+
+            //碰撞检测可以改用距离场：每个栅格到最近障碍物的距离，每次规划前只增量更新变化的区域
+            double minClearance, maxFieldDistance;
+            loadParam(private_nh.get(), "use_distance_field", useDistanceField_, true);
+            loadParam(private_nh.get(), "min_clearance", minClearance, 0.0);
+            loadParam(private_nh.get(), "distance_field_max", maxFieldDistance, 1.0);
+            if(useDistanceField_)
+            {
+                distanceField_.setMaxDistance(max(maxFieldDistance, minClearance + 2 * costmap_->getResolution()));
+                collisionChecker_.setDistanceField(&distanceField_, minClearance);
+            }
+
+            //按机器人足迹做碰撞检测：每个离散朝向预先栅格化一个足迹掩码，只有致命障碍物栅格算碰撞
+            int footprintHeadings;
+            loadParam(private_nh.get(), "footprint_checking", footprintChecking_, false);
+            loadParam(private_nh.get(), "footprint_headings", footprintHeadings, 16);
+            if(footprintChecking_)
+            {
+                if(footprint.size() < 3)
+                    ROS_WARN("footprint_checking is set but no robot footprint is available, checking the robot as a point");
+                footprintMasks_.setHeadings(footprintHeadings);
+                footprintMasks_.update(footprint, costmap_->getResolution());
+                collisionChecker_.setFootprint(&footprintMasks_);
+            }
+
+            //anytime模式：找到第一条路径后继续优化，直到时间或迭代次数用完，返回代价最小的路径
+            loadParam(private_nh.get(), "anytime", anytime_, false);
+            loadParam(private_nh.get(), "max_planning_time", maxPlanningTime_, 1.0);
+            loadParam(private_nh.get(), "max_iterations", maxIterations_, 0);
+            loadParam(private_nh.get(), "informed_sampling", informedSampling_, true);
+
+            //树和近邻缓冲区在这里一次性预留，每次规划只清空不释放，规划循环中不再分配内存
+            int nodeCapacity;
+            loadParam(private_nh.get(), "node_capacity", nodeCapacity, 20000);
+            nodeCapacity = maxIterations_ > 0 ? max(nodeCapacity, maxIterations_ + 2) : nodeCapacity;
+            rrtTree.reserve(nodeCapacity);
+            neighborIDs_.reserve(256);
+            const int pathCapacity = 1024;
+            pathBuffer_.reserve(pathCapacity);
+            planX_.reserve(pathCapacity);
+            planY_.reserve(pathCapacity);
+            goalNodeIDs_.reserve(256);
+
+            //路径后处理：捷径、去掉共线点、按间距重采样，并设置每个位姿的朝向
+            int shortcutIterations;
+            double collinearTolerance, pathResolution;
+            loadParam(private_nh.get(), "smooth_path", smoothPath_, true);
+            loadParam(private_nh.get(), "shortcut_iterations", shortcutIterations, 100);
+            loadParam(private_nh.get(), "collinear_tolerance", collinearTolerance, 0.01);
+            loadParam(private_nh.get(), "path_resolution", pathResolution, 0.0);
+            pathSmoother_.setCollisionChecker(&collisionChecker_);
+            pathSmoother_.configure(shortcutIterations, collinearTolerance, pathResolution, pathCapacity);
+
+            //多线程并行RRT*：多个线程在同一棵树上采样、扩展和重布线，查询不加锁，只有修改树时串行
+            //没有多核上的加速数据：只在单核上测过，那里多线程只有开销（吞吐量为单线程的0.81-1.09倍），
+            //所以默认单线程；在目标机器上用rrt_star_benchmark --sweep planner_threads=1,2,4,8测量
+            loadParam(private_nh.get(), "planner_threads", plannerThreads_, 1);
+
+            //目标不变时重用上一次规划的树
+            loadParam(private_nh.get(), "reuse_tree", reuseTree_, false);
+
+            //动态重规划：同样沿用上一次的树，但只重新检查经过代价地图变化区域的边，剪断失效的边后把孤儿子树接回
+            loadParam(private_nh.get(), "dynamic_replanning", dynamicReplanning_, false);
+            clearance_ = useDistanceField_ ? minClearance : 0.0;
+            treeRepair_.setMargin(clearance_ + (footprintChecking_ ? footprintMasks_.circumscribedRadius() : 0.0));
+            freeSpace_.setMargin(clearance_ + (footprintChecking_ ? footprintMasks_.circumscribedRadius() : 0.0));
+
+            //规划前检查起点和终点，并在降采样的地图上用连通域判断是否可达
+            int reachabilityDownsample;
+            loadParam(private_nh.get(), "reachability_check", reachabilityCheck_, true);
+            loadParam(private_nh.get(), "reachability_downsample", reachabilityDownsample, 4);
+            reachability_.setDownsample(reachabilityDownsample);
+            snapshot_.setLethalOnly(footprintChecking_ && !footprintMasks_.empty());
+
+            //只在空闲栅格中采样，地图上的障碍物和与起点不连通的区域不再产生被拒绝的采样点
+            loadParam(private_nh.get(), "free_space_sampling", freeSpaceSampling_, true);
+
+            //双向RRT*-Connect：起点和目标各长一棵树，每次扩展后尝试把另一棵树贪心地连过来
+            loadParam(private_nh.get(), "bidirectional", bidirectional_, false);
+            if(bidirectional_)
+            {
+                if(plannerThreads_ > 1)
+                    ROS_WARN("The bidirectional planner is single threaded, ignoring planner_threads");
+                if(reuseTree_ || dynamicReplanning_)
+                    ROS_WARN("The bidirectional planner does not reuse trees, ignoring reuse_tree and dynamic_replanning");
+                goalTree_.reserve(nodeCapacity);
+                connections_.reserve(256);
+            }
+
+            //近邻选择策略：fixed为固定半径，radius为随节点数收缩的RRT*半径，knearest为k近邻
+            std::string neighborPolicy;
+            loadParam(private_nh.get(), "step_size", rrtStepSize_, 0.05);
+            loadParam(private_nh.get(), "neighbor_policy", neighborPolicy, std::string("radius"));
+            loadParam(private_nh.get(), "neighbor_radius", neighborRadius_, NEIGHBOR_RADIUS);
+            loadParam(private_nh.get(), "rrt_gamma", rrtGammaParam_, 0.0);
+            loadParam(private_nh.get(), "k_rrt", kRRT_, 1.5 * M_E);
+            loadParam(private_nh.get(), "max_neighbors", maxNeighbors_, 0);
+            if(neighborPolicy == "knearest")
+                neighborPolicy_ = KNEAREST_NEIGHBORS;
+            else if(neighborPolicy == "fixed")
+                neighborPolicy_ = FIXED_RADIUS;
+            else
+                neighborPolicy_ = SHRINKING_RADIUS;
+
+            //采样器：固定random_seed可以复现规划结果，负数表示每次规划用时间作为种子
+            std::string sampleSequence;
+            loadParam(private_nh.get(), "random_seed", randomSeed_, -1);
+            loadParam(private_nh.get(), "sample_sequence", sampleSequence, std::string("uniform"));
+            sampleSequence_ = sampleSequence == "halton" ? Sampler::HALTON : Sampler::UNIFORM;
+            sampler_.setSequence(sampleSequence_);
+            roadmapSampler_.setSequence(sampleSequence_);
+
+            //多查询模式：静态地图上反复查询时，在整张地图上生长一张持久的路图，每个查询只做连接和图搜索；
+            //路图只在地图变化时丢弃，makeCostMatrix也使用这张路图
+            double roadmapRadius;
+            int roadmapMaxDegree;
+            loadParam(private_nh.get(), "multi_query", multiQuery_, false);
+            loadParam(private_nh.get(), "roadmap_nodes", roadmapNodes_, 5000);
+            loadParam(private_nh.get(), "roadmap_max_nodes", roadmapMaxNodes_, 50000);
+            loadParam(private_nh.get(), "roadmap_radius", roadmapRadius, 0.5);
+            loadParam(private_nh.get(), "roadmap_max_degree", roadmapMaxDegree, 10);
+            roadmapMaxNodes_ = max(roadmapMaxNodes_, roadmapNodes_);
+            roadmap_.configure(roadmapRadius, roadmapMaxDegree);
+            roadmap_.reserve(roadmapNodes_);
+            if(multiQuery_ && (bidirectional_ || reuseTree_ || dynamicReplanning_))
+                ROS_WARN("multi_query answers queries from the roadmap, ignoring bidirectional, reuse_tree and dynamic_replanning");
+
+            //可视化在后台线程中限频发布，每次只发送新增的边；关闭时不产生任何开销
+            double visualizationRate;
+            int visualizationMaxEdges;
+            loadParam(private_nh.get(), "visualize", visualize_, true);
+            loadParam(private_nh.get(), "visualization_rate", visualizationRate, 2.0);
+            loadParam(private_nh.get(), "visualization_max_edges", visualizationMaxEdges, 5000);
+            if(visualize_ && !ros::isInitialized())
+            {
+                ROS_WARN("ROS is not initialized, disabling visualization");
+                visualize_ = false;
+            }
+            if(visualize_)
+            {
+                visualization_msgs::Marker sourcePoint, goalPoint, randomPoint, rrtTreeMarker, rrtTreeMarker1, rrtTreeMarker2, finalPath;
+                initializeMarkers(sourcePoint, goalPoint, randomPoint, rrtTreeMarker, rrtTreeMarker1, rrtTreeMarker2, finalPath);
+                visualizer_.setStyle(TreeVisualizer::TREE_EDGE, rrtTreeMarker);
+                visualizer_.setStyle(TreeVisualizer::PARENT_EDGE, rrtTreeMarker1);
+                visualizer_.setStyle(TreeVisualizer::REWIRE_EDGE, rrtTreeMarker2);
+                ros::NodeHandle nh;
+                visualizer_.start(nh, "path_planner_rrt", visualizationRate, visualizationMaxEdges);
+            }
+
+            //每次规划结束后在diagnostics上发布各阶段耗时和计数
+            loadParam(private_nh.get(), "publish_diagnostics", publishDiagnostics_, true);
+            if(publishDiagnostics_ && ros::isInitialized())
+            {
+                ros::NodeHandle nh;
+                diagnosticsPub_ = nh.advertise<diagnostic_msgs::DiagnosticArray>("diagnostics", 1);
+            }
+            else
+                publishDiagnostics_ = false;
+
+            //树快照：每次规划后把树写入文件供离线分析；启动时可以从文件载入树，第一次规划直接在它上面热启动
+            bool loadTreeSnapshot;
+            loadParam(private_nh.get(), "tree_snapshot_file", treeSnapshotFile_, std::string(""));
+            loadParam(private_nh.get(), "save_tree_snapshot", saveTreeSnapshot_, false);
+            loadParam(private_nh.get(), "load_tree_snapshot", loadTreeSnapshot, false);
+            treeLoaded_ = false;
+            if(loadTreeSnapshot && !treeSnapshotFile_.empty())
+            {
+                if(multiQuery_ || bidirectional_)
+                    ROS_WARN("load_tree_snapshot is ignored by the multi_query and bidirectional planners");
+                else
+                    loadTree(treeSnapshotFile_);
+            }
+
+            //异步规划：后台线程规划，makePlan立即返回最新的有效路径，新目标会取消正在进行的规划
+            bool asyncPlanning;
+            double asyncReplanPeriod, asyncIdleTimeout;
+            loadParam(private_nh.get(), "async_planning", asyncPlanning, false);
+            loadParam(private_nh.get(), "async_replan_period", asyncReplanPeriod, 0.5);
+            loadParam(private_nh.get(), "async_idle_timeout", asyncIdleTimeout, 5.0);
+            loadParam(private_nh.get(), "async_wait_time", asyncWaitTime_, 0.0);
+            if(asyncPlanning)
+                asyncPlanner_.start([this](const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                                           std::vector<geometry_msgs::PoseStamped> &plan) { return planSync(start, goal, plan); },
+                                    [this]() { publishedStats_ = stats_; },
+                                    asyncReplanPeriod, asyncIdleTimeout);
+
             initialized_ = true;
         }
         else
@@ -67,7 +352,7 @@ void RRT::initNode(RRT::rrtNode &newNode, const geometry_msgs::PoseStamped& star
     newNode.parentID = 0;
     newNode.nodeID = 0;
     newNode.cost=0;
-    rrtTree.push_back(newNode);
+    rrtTree.add(newNode.posX, newNode.posY, newNode.parentID, newNode.cost);
 }
 
 /**
@@ -76,23 +361,100 @@ void RRT::initNode(RRT::rrtNode &newNode, const geometry_msgs::PoseStamped& star
 */
 vector<RRT::rrtNode> RRT::getTree()
 {
-    return rrtTree;
+    vector<RRT::rrtNode> tree;
+    for(int i=0; i<getTreeSize(); i++)
+        tree.push_back(getNode(i));
+    return tree;
 }
 
 
 vector<RRT::rrtNode> RRT::getNearestNeighbor(int tempNodeID)//不要忘记补头文件；目的是在一定范围内找到新节点附近的近邻节点
 {
-    double win_r=0.15;
     vector<RRT::rrtNode> rrtNeighbor;
-    for(int i=0;i<getTreeSize();i++)
+    getNearestNeighbor(tempNodeID, rrtNeighbor);
+    return rrtNeighbor;
+}
+
+/**
+* fills rrtNeighbor with the near neighbors of the given node
+* Reuses the nodes already in the vector (including their children lists),
+* so calling it again with the same vector does not allocate once it has grown.
+*/
+void RRT::getNearestNeighbor(int tempNodeID, vector<RRT::rrtNode> &rrtNeighbor)
+{
+    const vector<int> &ids = getNearestNeighborIDs(tempNodeID);
+    rrtNeighbor.resize(ids.size());
+    for(int i=0;i<ids.size();i++)
+        getNode(ids[i], rrtNeighbor[i]);
+}
+
+/**
+* ids of the nodes within the neighbor radius of the given node, in ascending order
+* @return reference to a buffer that is overwritten by the next call
+*/
+const vector<int> &RRT::getNearestNeighborIDs(int tempNodeID)
+{
+    RRT_PROFILE_SCOPE(stats_.profile, NEAREST);
+    findNeighbors(getPosX(tempNodeID), getPosY(tempNodeID), tempNodeID, neighborIDs_);
+    return neighborIDs_;
+}
+
+/**
+* near neighbors of a point according to neighbor_policy
+* fixed: every node within neighbor_radius
+* radius: RRT* radius gamma*(log n/n)^(1/2), between the step size and neighbor_radius
+* knearest: the k_rrt*log n nearest nodes
+* Both the radius and the count shrink relative to the tree as it grows, so
+* rewiring stays logarithmic per iteration. max_neighbors, if set, keeps only
+* the closest ones. Only reads the tree, so the parallel workers can call it
+* under a shared lock.
+* @param excludeID node left out of the result (the query node itself), -1 for none
+* @param result filled with node ids in ascending order
+*/
+void RRT::findNeighbors(double X, double Y, int excludeID, vector<int> &result)
+{
+    findNeighbors(rrtTree, X, Y, excludeID, result);
+}
+
+/**
+* near neighbors of a point in the given tree, see findNeighbors above
+*/
+void RRT::findNeighbors(const NodeStore &tree, double X, double Y, int excludeID, vector<int> &result)
+{
+    int n = tree.size();
+    double logN = log(double(max(n, 2)));
+    if(neighborPolicy_ == KNEAREST_NEIGHBORS)
+    {
+        int k = int(ceil(kRRT_ * logN));
+        if(maxNeighbors_ > 0)
+            k = min(k, maxNeighbors_);
+        tree.nearestK(X, Y, excludeID >= 0 ? k + 1 : k, result);
+    }
+    else
+    {
+        double r = neighborRadius_;
+        if(neighborPolicy_ == SHRINKING_RADIUS)
+            r = min(max(rrtGamma_ * sqrt(logN / n), rrtStepSize_), neighborRadius_);
+        tree.radius(X, Y, r, result);
+    }
+
+    if(excludeID >= 0)
+    {
+        vector<int>::iterator self = lower_bound(result.begin(), result.end(), excludeID);
+        if(self != result.end() && *self == excludeID)
+            result.erase(self);
+    }
+    if(maxNeighbors_ > 0 && result.size() > maxNeighbors_)
     {
-        if ( getEuclideanDistance(getPosX(tempNodeID),getPosY(tempNodeID),getPosX(i),getPosY(i))<=win_r)//新节点和每一个节点
+        const vector<double> &treeX = tree.posX();
+        const vector<double> &treeY = tree.posY();
+        nth_element(result.begin(), result.begin() + maxNeighbors_, result.end(), [&](int l, int r)
         {
-            //这里应该是一个专门用来存储近邻节点的向量 
-            rrtNeighbor.push_back(getNode(i));
-        }   
+            return caldistance(X, Y, treeX[l], treeY[l]) < caldistance(X, Y, treeX[r], treeY[r]);
+        });
+        result.resize(maxNeighbors_);
+        sort(result.begin(), result.end());
     }
-    return rrtNeighbor;
 }
 
 /**
@@ -101,7 +463,9 @@ vector<RRT::rrtNode> RRT::getNearestNeighbor(int tempNodeID)//不要忘记补头
 */
 void RRT::setTree(vector<RRT::rrtNode> input_rrtTree)
 {
-    rrtTree = input_rrtTree;
+    rrtTree.clear();
+    for(int i=0; i<input_rrtTree.size(); i++)
+        rrtTree.add(input_rrtTree[i].posX, input_rrtTree[i].posY, input_rrtTree[i].parentID, input_rrtTree[i].cost);
 }
 
 /**
@@ -118,12 +482,12 @@ int RRT::getTreeSize()
 */
 void RRT::addNewNode(RRT::rrtNode node)
 {
-    rrtTree.push_back(node);
+    rrtTree.add(node.posX, node.posY, node.parentID, node.cost);
 }
 
 void RRT::deleteNewNode()
 {
-    rrtTree.pop_back();
+    rrtTree.popBack();
 }
 
 /**
@@ -132,8 +496,8 @@ void RRT::deleteNewNode()
 */
 RRT::rrtNode RRT::removeNode(int id)
 {
-    RRT::rrtNode tempNode = rrtTree[id];
-    rrtTree.erase(rrtTree.begin()+id);
+    RRT::rrtNode tempNode = getNode(id);
+    rrtTree.erase(id);//删除节点后其后所有节点的ID都会前移
     return tempNode;
 }
 
@@ -144,7 +508,24 @@ RRT::rrtNode RRT::removeNode(int id)
 */
 RRT::rrtNode RRT::getNode(int id)
 {
-    return rrtTree[id];
+    RRT::rrtNode node;
+    getNode(id, node);
+    return node;
+}
+
+/**
+* copies a node into an existing rrtNode, keeping the capacity of its children list
+*/
+void RRT::getNode(int id, RRT::rrtNode &node)
+{
+    node.nodeID = id;
+    node.posX = rrtTree.x(id);
+    node.posY = rrtTree.y(id);
+    node.parentID = rrtTree.parent(id);
+    node.cost = rrtTree.cost(id);
+    node.children.clear();
+    for(int c=rrtTree.firstChild(id); c>=0; c=rrtTree.nextSibling(c))
+        node.children.push_back(c);
 }
 
 /**
@@ -155,18 +536,8 @@ RRT::rrtNode RRT::getNode(int id)
 */
 int RRT::getNearestNodeID(double X, double Y)
 {
-    int i, returnID;
-    double distance = 9999, tempDistance;
-    for(i=0; i<this->getTreeSize(); i++)
-    {
-        tempDistance = getEuclideanDistance(X,Y, getPosX(i),getPosY(i));
-        if (tempDistance < distance)
-        {
-            distance = tempDistance;
-            returnID = i;
-        }
-    }
-    return returnID;
+    RRT_PROFILE_SCOPE(stats_.profile, NEAREST);
+    return rrtTree.nearest(X, Y);
 }
 
 /**
@@ -174,7 +545,7 @@ int RRT::getNearestNodeID(double X, double Y)
 */
 double RRT::getPosX(int nodeID)
 {
-    return rrtTree[nodeID].posX;
+    return rrtTree.x(nodeID);
 }
 
 /**
@@ -182,7 +553,7 @@ double RRT::getPosX(int nodeID)
 */
 double RRT::getPosY(int nodeID)
 {
-    return rrtTree[nodeID].posY;
+    return rrtTree.y(nodeID);
 }
 
 /**
@@ -190,7 +561,7 @@ double RRT::getPosY(int nodeID)
 */
 void RRT::setPosX(int nodeID, double input_PosX)
 {
-    rrtTree[nodeID].posX = input_PosX;
+    rrtTree.setPos(nodeID, input_PosX, rrtTree.y(nodeID));
 }
 
 /**
@@ -198,7 +569,7 @@ void RRT::setPosX(int nodeID, double input_PosX)
 */
 void RRT::setPosY(int nodeID, double input_PosY)
 {
-    rrtTree[nodeID].posY = input_PosY;
+    rrtTree.setPos(nodeID, rrtTree.x(nodeID), input_PosY);
 }
 
 /**
@@ -206,23 +577,24 @@ void RRT::setPosY(int nodeID, double input_PosY)
 */
 RRT::rrtNode RRT::getParent(int id)
 {
-    return rrtTree[rrtTree[id].parentID];
+    return getNode(rrtTree.parent(id));
 }
 
 /**
-* set parentID of the given node
+* set parentID of the given node, the children lists follow automatically
 */
 void RRT::setParentID(int nodeID, int parentID)
 {
-    rrtTree[nodeID].parentID = parentID;
+    rrtTree.setParent(nodeID, parentID);
 }
 
 /**
 * add a new childID to the children list of the given node
+* a node has exactly one parent, so this re-parents childID under nodeID
 */
 void RRT::addChildID(int nodeID, int childID)
 {
-    rrtTree[nodeID].children.push_back(childID);
+    rrtTree.setParent(childID, nodeID);
 }
 
 /**
@@ -230,7 +602,10 @@ void RRT::addChildID(int nodeID, int childID)
 */
 vector<int> RRT::getChildren(int id)
 {
-    return rrtTree[id].children;
+    vector<int> children;
+    for(int c=rrtTree.firstChild(id); c>=0; c=rrtTree.nextSibling(c))
+        children.push_back(c);
+    return children;
 }
 
 /**
@@ -238,7 +613,7 @@ vector<int> RRT::getChildren(int id)
 */
 int RRT::getChildrenSize(int nodeID)
 {
-    return rrtTree[nodeID].children.size();
+    return rrtTree.childCount(nodeID);
 }
 
 /**
@@ -257,16 +632,25 @@ double RRT::getEuclideanDistance(double sourceX, double sourceY, double destinat
 vector<int> RRT::getRootToEndPath(int endNodeID)
 {
     vector<int> path;
-    path.push_back(endNodeID);
-    while(rrtTree[path.front()].nodeID != 0)//path.front()返回的是ID
-    {
-        std::cout<<rrtTree[path.front()].nodeID<<endl;
-        path.insert(path.begin(),rrtTree[path.front()].parentID);//这里的ID有问题导致循环跳不出去
-        //path.begin()是最后一个新节点的ID，随后插入的是前一个节点的父节点
-    }
+    getRootToEndPath(endNodeID, path);
     return path;
 }
 
+/**
+* fills path with the node ids from the root to the given node
+* The depth is counted first and the path filled back to front, so it costs
+* one pass per node and does not allocate if path already has the capacity.
+*/
+void RRT::getRootToEndPath(int endNodeID, vector<int> &path)
+{
+    int depth = 1;
+    for(int node=endNodeID; node != 0; node=rrtTree.parent(node))
+        depth++;
+    path.resize(depth);
+    for(int node=endNodeID; depth > 0; node=rrtTree.parent(node))
+        path[--depth] = node;
+}
+
 /*
 bool RRT::judgeangle2(RRT::rrtNode rrtNeighbor,int NeighborParent, int NeighborID, RRT::rrtNode tempNode,int tempNodeID)
 {
@@ -299,7 +683,7 @@ void RRT::initializeMarkers(visualization_msgs::Marker &sourcePoint,
     visualization_msgs::Marker &finalPath)//对于RRT*的标记来说，添加新的即可
     {
     //init headers
-	sourcePoint.header.frame_id    = goalPoint.header.frame_id    = randomPoint.header.frame_id    = rrtTreeMarker.header.frame_id    = rrtTreeMarker1.header.frame_id    = rrtTreeMarker2.header.frame_id    =finalPath.header.frame_id    = "map";
+	sourcePoint.header.frame_id    = goalPoint.header.frame_id    = randomPoint.header.frame_id    = rrtTreeMarker.header.frame_id    = rrtTreeMarker1.header.frame_id    = rrtTreeMarker2.header.frame_id    =finalPath.header.frame_id    = globalFrame_;
 	sourcePoint.header.stamp       = goalPoint.header.stamp       = randomPoint.header.stamp       = rrtTreeMarker.header.stamp       = rrtTreeMarker1.header.stamp       = rrtTreeMarker2.header.stamp       =finalPath.header.stamp       = ros::Time::now();
 	sourcePoint.ns                 = goalPoint.ns                 = randomPoint.ns                 = rrtTreeMarker.ns                 = rrtTreeMarker1.ns                 = rrtTreeMarker2.ns                 =finalPath.ns                 = "map";
 	sourcePoint.action             = goalPoint.action             = randomPoint.action             = rrtTreeMarker.action             = rrtTreeMarker1.action             = rrtTreeMarker2.action             =finalPath.action             = visualization_msgs::Marker::ADD;
@@ -352,15 +736,17 @@ void RRT::initializeMarkers(visualization_msgs::Marker &sourcePoint,
 	sourcePoint.color.a = goalPoint.color.a = randomPoint.color.a = rrtTreeMarker.color.a = rrtTreeMarker1.color.a = rrtTreeMarker2.color.a = finalPath.color.a = 1.0f;
     }
 
-void RRT::generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,costmap_2d::Costmap2D* costmap_)
+void RRT::generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,const CostmapSnapshot &map)
 {
+    RRT_PROFILE_SCOPE(stats_.profile, SAMPLING);
+    RRT_PROFILE_COUNT(stats_.profile, SAMPLES_DRAWN);
     float probability=0.2;
-    double maxx = costmap_->getSizeInMetersX() - costmap_->getOriginX();
-    double minx = costmap_->getOriginX();
-    double maxy = costmap_->getSizeInMetersY() - costmap_->getOriginY();
-    double miny = costmap_->getOriginY();
+    double maxx = map.getOriginX() + map.getSizeInMetersX();
+    double minx = map.getOriginX();
+    double maxy = map.getOriginY() + map.getSizeInMetersY();
+    double miny = map.getOriginY();
 
-    if (rand()/double(RAND_MAX)<probability)
+    if (sampler_.uniform()<probability)
     {
         tempNode.posX=goalX;
         tempNode.posY=goalY;
@@ -368,8 +754,15 @@ void RRT::generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,co
     }
     else
     {
-        double x = double(rand())/double(RAND_MAX)*(maxx - minx) + minx;
-        double y = double(rand())/double(RAND_MAX)*(maxy - miny) + miny;
+        double u, v, x, y;
+        sampler_.point(u, v);
+        if(freeSpaceSampling_ && !freeSpace_.empty())
+            freeSpace_.sample(u, v, x, y);
+        else
+        {
+            x = u*(maxx - minx) + minx;
+            y = v*(maxy - miny) + miny;
+        }
         //int x = rand() % maxx ;
         //int y = rand() % maxy ;
         //std::cout<<"Random X: "<<x <<endl<<"Random Y: "<<y<<endl;
@@ -379,26 +772,49 @@ void RRT::generateTempPoint(RRT::rrtNode &tempNode,double goalX, double goalY,co
     }
 }
 
-bool RRT::judgeangle1(RRT::rrtNode tempNode)
+/**
+* informed sampling: draws a point uniformly from the ellipse with foci at
+* start and goal whose transverse diameter is the best path cost found so far
+* Only points inside this ellipse can be part of a shorter path.
+* @param bestCost cost of the current best path from start to goal
+*/
+void RRT::generateInformedPoint(RRT::rrtNode &tempNode, double startX, double startY,
+                                double goalX, double goalY, double bestCost)
+{
+    RRT_PROFILE_SCOPE(stats_.profile, SAMPLING);
+    RRT_PROFILE_COUNT(stats_.profile, SAMPLES_DRAWN);
+    double minCost = getEuclideanDistance(startX, startY, goalX, goalY);
+    double a = bestCost / 2;//长半轴
+    double b = bestCost > minCost ? sqrt(bestCost * bestCost - minCost * minCost) / 2 : 0;//短半轴
+    double theta = atan2(goalY - startY, goalX - startX);
+
+    //先在单位圆内均匀采样，再拉伸、旋转、平移到椭圆上
+    double r = sqrt(sampler_.uniform());
+    double phi = 2 * PI * sampler_.uniform();
+    double ex = a * r * cos(phi), ey = b * r * sin(phi);
+
+    tempNode.posX = (startX + goalX) / 2 + ex * cos(theta) - ey * sin(theta);
+    tempNode.posY = (startY + goalY) / 2 + ex * sin(theta) + ey * cos(theta);
+}
+
+bool RRT::judgeangle1(const RRT::rrtNode &tempNode)
 {
     int nearestNodeID = getNearestNodeID(tempNode.posX,tempNode.posY);
-    RRT::rrtNode nearestNode = getNode(nearestNodeID);
+    double nearestX = getPosX(nearestNodeID), nearestY = getPosY(nearestNodeID);
+    int nearestParentID = rrtTree.parent(nearestNodeID);
 
-    double theta = atan2(tempNode.posY - nearestNode.posY,tempNode.posX - nearestNode.posX);//这个角度意义不对
-    vector<double> n1,n2;
-    if(nearestNode.parentID==0)
+    double n1[2], n2[2];
+    n1[0] = tempNode.posX - nearestX;
+    n1[1] = tempNode.posY - nearestY;
+    if(nearestParentID==0)
     {
-        n1.push_back(tempNode.posX - nearestNode.posX);
-        n1.push_back(tempNode.posY - nearestNode.posY);
-        n2.push_back(0.0001);
-        n2.push_back(0.0001);
+        n2[0] = 0.0001;
+        n2[1] = 0.0001;
     }
     else
     {
-        n1.push_back(tempNode.posX - nearestNode.posX);
-        n1.push_back(tempNode.posY - nearestNode.posY);
-        n2.push_back(nearestNode.posX-getPosX(nearestNode.parentID));
-        n2.push_back(nearestNode.posY-getPosY(nearestNode.parentID));
+        n2[0] = nearestX-getPosX(nearestParentID);
+        n2[1] = nearestY-getPosY(nearestParentID);
     }
     
     double phy = acos((n1[0]*n2[0]+n1[1]*n2[1])/(sqrt(n1[0]*n1[0]+n1[1]*n1[1])*sqrt(n2[0]*n2[0]+n2[1]*n2[1])));
@@ -410,25 +826,24 @@ bool RRT::addNewPointtoRRT(RRT::rrtNode &tempNode, double rrtStepSize)
 {
     int nearestNodeID = getNearestNodeID(tempNode.posX,tempNode.posY);//由此启发：是否可以写一个myRRT.getNearestNeighbor?具体函数写在rrt.cpp中
 
-    RRT::rrtNode nearestNode = getNode(nearestNodeID);//这里getNode 获得的节点是一个结构体包含很多信息
+    double nearestX = getPosX(nearestNodeID), nearestY = getPosY(nearestNodeID);
 
-    double theta = atan2(tempNode.posY - nearestNode.posY,tempNode.posX - nearestNode.posX);
+    double theta = atan2(tempNode.posY - nearestY,tempNode.posX - nearestX);
 
     //if(theta<=PI/4)//出现问题是因为如果不满足该条件，没有后续动作会强行链接上一次存储在Marker中的值
-        tempNode.posX = nearestNode.posX + (rrtStepSize * cos(theta));//这里tempNode变成了新节点
-        tempNode.posY = nearestNode.posY + (rrtStepSize * sin(theta));
+        tempNode.posX = nearestX + (rrtStepSize * cos(theta));//这里tempNode变成了新节点
+        tempNode.posY = nearestY + (rrtStepSize * sin(theta));
 
-    if(checkIfInsideBoundary(tempNode) && checkIfOutsideObstacles(tempNode))//checkIfOutsideObstacles(obstArray,tempNode))
+    if(checkIfInsideBoundary(tempNode) && checkIfEdgeOutsideObstacles(stats_.profile, nearestX, nearestY, tempNode.posX, tempNode.posY))//checkIfOutsideObstacles(obstArray,tempNode))
     {
         tempNode.parentID = nearestNodeID;
-        tempNode.nodeID = rrtTree.size();
         //myRRT.addNewNode(tempNode);//这里tempNode表示新节点，今后RRT×的操作就基于这个新节点
-        tempNode.cost=sqrt(pow(nearestNode.posX - tempNode.posX,2) + pow(nearestNode.posY - tempNode.posY,2))+\
-                      nearestNode.cost;//计算每个新节点的代价,私有成员不能随意调用
+        tempNode.cost=sqrt(pow(nearestX - tempNode.posX,2) + pow(nearestY - tempNode.posY,2))+\
+                      rrtTree.cost(nearestNodeID);//计算每个新节点的代价,私有成员不能随意调用
                       //std::cout<<"tempNode.cost= "<<tempNode.cost<<endl;//////////////////////////////////////////
                       //std::cout<<"tempNode.posX: "<<tempNode.posX<<"  tempNode.posY"<<tempNode.posY<<endl;
        // rrtTree.push_back(tempNode);//这里tempNode表示新节点，今后RRT×的操作就基于这个新节点
-       rrtTree.push_back(tempNode);
+       tempNode.nodeID = rrtTree.add(tempNode.posX, tempNode.posY, tempNode.parentID, tempNode.cost);
     
         return true;
     }
@@ -439,29 +854,45 @@ bool RRT::addNewPointtoRRT(RRT::rrtNode &tempNode, double rrtStepSize)
 
 bool RRT::checkIfInsideBoundary(RRT::rrtNode &tempNode)
 {
-    if(tempNode.posX < costmap_->getOriginX() || tempNode.posY < costmap_->getOriginY()  \
-    || tempNode.posX > costmap_->getSizeInMetersX() - costmap_->getOriginX() \
-    || tempNode.posY > costmap_->getSizeInMetersY() - costmap_->getOriginY() ) 
+    return checkIfInsideBoundary(tempNode.posX, tempNode.posY);
+}
+
+bool RRT::checkIfInsideBoundary(double X, double Y)
+{
+    if(X < snapshot_.getOriginX() || Y < snapshot_.getOriginY()  \
+    || X > snapshot_.getOriginX() + snapshot_.getSizeInMetersX() \
+    || Y > snapshot_.getOriginY() + snapshot_.getSizeInMetersY() ) 
     return false;
     else return true;
 }
 
 bool RRT::checkIfOutsideObstacles(RRT::rrtNode tempNode)
 {
-    unsigned int gridx,gridy;
-    unsigned char* grid = costmap_->getCharMap();
-    if(costmap_->worldToMap(tempNode.posX, tempNode.posY, gridx, gridy))
-    {     
-        int index = costmap_->getIndex(gridx, gridy);
-        if(grid[index]!=FREE_SPACE&&grid[index]!=NO_INFORMATION)
-        {
-                return false;
-        }
-        else
-        return true;
-    }
-    else
-    return false;
+    return checkIfOutsideObstacles(tempNode.posX, tempNode.posY);
+}
+
+bool RRT::checkIfOutsideObstacles(double X, double Y)
+{
+    return collisionChecker_.pointFree(X, Y);
+}
+
+/**
+* checks every costmap cell the straight edge between two points passes through
+* @return true if the whole edge is free
+*/
+bool RRT::checkIfEdgeOutsideObstacles(double startX, double startY, double endX, double endY)
+{
+    return collisionChecker_.segmentFree(startX, startY, endX, endY);
+}
+
+/**
+* edge check on the planner hot path, timed and counted in the given profiler
+*/
+bool RRT::checkIfEdgeOutsideObstacles(PlanProfiler &profiler, double startX, double startY, double endX, double endY)
+{
+    RRT_PROFILE_SCOPE(profiler, COLLISION);
+    RRT_PROFILE_COUNT(profiler, COLLISION_CHECKS);
+    return collisionChecker_.segmentFree(startX, startY, endX, endY);
 }
 
 void RRT::addBranchtoRRTTree(visualization_msgs::Marker &rrtTreeMarker, RRT::rrtNode &tempNode)//针对RRT*来说另外写一个函数
@@ -474,47 +905,16 @@ point.y = tempNode.posY;
 point.z = 0;
 rrtTreeMarker.points.push_back(point);
 
-RRT::rrtNode parentNode = getParent(tempNode.nodeID);
+int parentID = rrtTree.parent(tempNode.nodeID);
 
-point.x = parentNode.posX;
-point.y = parentNode.posY;
+point.x = getPosX(parentID);
+point.y = getPosY(parentID);
 point.z = 0;
 
 rrtTreeMarker.points.push_back(point);//之所以把新生成的节点和其父节点都加入到rrtTreeMarker，是因为visualization_msgs::Marker LINE_LIST 的性质，链接两个新加入的节点
 }
 
 
-void RRTStarprocess1(visualization_msgs::Marker &rrtTreeMarker1, RRT::rrtNode &q_min,RRT::rrtNode &tempNode)
-{
-    geometry_msgs::Point point;
-
-    point.x = tempNode.posX;//这里的tempNode 是新生成的节点
-    point.y = tempNode.posY;
-    point.z = 0;
-    rrtTreeMarker1.points.push_back(point);
-
-    point.x = q_min.posX;
-    point.y = q_min.posY;
-    point.z = 0;
-    rrtTreeMarker1.points.push_back(point);
-}
-
-void RRTStarprocess2(visualization_msgs::Marker &rrtTreeMarker2, RRT::rrtNode &q_min1, RRT::rrtNode &tempNode)
-{
-    geometry_msgs::Point point;
-
-    point.x=tempNode.posX;
-    point.y=tempNode.posY;
-    point.z=0;
-    rrtTreeMarker2.points.push_back(point);
-
-    point.x=q_min1.posX;
-    point.y=q_min1.posY;
-    point.z=0;
-    rrtTreeMarker2.points.push_back(point);
-}
-
-
 bool RRT::checkNodetoGoal(double X, double Y, RRT::rrtNode &tempNode)
 {
     double distance = sqrt(pow(X-tempNode.posX,2)+pow(Y-tempNode.posY,2));
@@ -529,14 +929,12 @@ bool RRT::checkNodetoGoal(double X, double Y, RRT::rrtNode &tempNode)
 
 void RRT::setFinalPathData(vector< vector<int> > &rrtPaths,  int i, visualization_msgs::Marker &finalpath, double goalX, double goalY)
 {
-    RRT::rrtNode tempNode;
     geometry_msgs::Point point;
+    finalpath.points.reserve(finalpath.points.size() + rrtPaths[i].size() + 1);
     for(int j=0; j<rrtPaths[i].size();j++)
     {
-        tempNode = getNode(rrtPaths[i][j]);
-
-        point.x = tempNode.posX;
-        point.y = tempNode.posY;
+        point.x = getPosX(rrtPaths[i][j]);
+        point.y = getPosY(rrtPaths[i][j]);
         point.z = 0;
 
         finalpath.points.push_back(point);
@@ -547,156 +945,709 @@ void RRT::setFinalPathData(vector< vector<int> > &rrtPaths,  int i, visualizatio
     finalpath.points.push_back(point);
 }
 
-double caldistance(double sourceX, double sourceY, double destinationX, double destinationY)
+
+/**
+* converts a root to end path into poses: every path node but the last one, then the goal
+* With smooth_path the waypoints are shortcut and compressed by the PathSmoother
+* first. Every pose but the last faces the next one; the last is the goal pose.
+*/
+void RRT::getPlanFromPath(const vector<int> &path, const geometry_msgs::PoseStamped& start,
+    const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan)
 {
-    return sqrt(pow(destinationX - sourceX,2) + pow(destinationY - sourceY,2));
+    planX_.clear();
+    planY_.clear();
+    for(int i=0; i+1<path.size(); i++)
+    {
+        planX_.push_back(getPosX(path[i]));
+        planY_.push_back(getPosY(path[i]));
+    }
+    planX_.push_back(goal.pose.position.x);
+    planY_.push_back(goal.pose.position.y);
+    buildPlan(start, goal, plan);
 }
 
+/**
+* turns the waypoints in planX_/planY_, which end at the goal, into the plan
+*/
+void RRT::buildPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                    std::vector<geometry_msgs::PoseStamped>& plan)
+{
+    stats_.rawPathCost = PathSmoother::length(planX_, planY_);
+    if(smoothPath_)
+        pathSmoother_.smooth(planX_, planY_, sampler_);
 
+    plan.clear();
+    plan.reserve(planX_.size());
+    for(int i=0; i+1<planX_.size(); i++)
+    {
+        geometry_msgs::PoseStamped pose=start;
+        pose.pose.position.x=planX_[i];
+        pose.pose.position.y=planY_[i];
+        double yaw = atan2(planY_[i+1] - planY_[i], planX_[i+1] - planX_[i]);
+        pose.pose.orientation.x = 0;
+        pose.pose.orientation.y = 0;
+        pose.pose.orientation.z = sin(yaw / 2);
+        pose.pose.orientation.w = cos(yaw / 2);
+        plan.push_back(pose);
+    }
+    plan.push_back(goal);
+}
 
+/**
+* re-parents a node during rewiring and brings its cost and the costs of its
+* whole subtree up to date
+*/
+void RRT::rewireNode(int nodeID, int parentID)
+{
+    rewireNode(rrtTree, nodeID, parentID);
+}
 
+void RRT::rewireNode(NodeStore &tree, int nodeID, int parentID)
+{
+    tree.setParent(nodeID, parentID);
+    tree.setCost(nodeID, tree.cost(parentID) + caldistance(tree.x(parentID), tree.y(parentID), tree.x(nodeID), tree.y(nodeID)));
+    tree.updateSubtreeCost(nodeID);
+}
 
-bool RRT::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,  std::vector<geometry_msgs::PoseStamped>& plan )
+/**
+* records a node inside the goal region and makes it the best goal node if it is cheaper
+*/
+void RRT::addGoalNode(int nodeID, double goalX, double goalY)
 {
+    markSolutionFound();
+    goalNodeIDs_.push_back(nodeID);
+    double goalCost = rrtTree.cost(nodeID) + getEuclideanDistance(getPosX(nodeID), getPosY(nodeID), goalX, goalY);
+    if(goalCost < bestGoalCost_)
+    {
+        bestGoalCost_ = goalCost;
+        bestGoalNodeID_ = nodeID;
+    }
+}
 
-    plan.clear();
-    rrtTree.clear();
-    ros::Publisher rrt_publisher = pn.advertise<visualization_msgs::Marker> ("path_planner_rrt",1000);
+/**
+* picks the cheapest node in the goal region again after rewiring changed costs
+*/
+void RRT::updateBestGoal(double goalX, double goalY)
+{
+    bestGoalNodeID_ = -1;
+    bestGoalCost_ = numeric_limits<double>::max();
+    for(int i=0; i<goalNodeIDs_.size(); i++)
+    {
+        int node = goalNodeIDs_[i];
+        double goalCost = rrtTree.cost(node) + getEuclideanDistance(getPosX(node), getPosY(node), goalX, goalY);
+        if(goalCost < bestGoalCost_)
+        {
+            bestGoalCost_ = goalCost;
+            bestGoalNodeID_ = node;
+        }
+    }
+}
 
-	//defining markers
-    visualization_msgs::Marker sourcePoint;
-    visualization_msgs::Marker goalPoint;
-    visualization_msgs::Marker randomPoint;
-    visualization_msgs::Marker rrtTreeMarker;
-    visualization_msgs::Marker rrtTreeMarker1;
-    visualization_msgs::Marker rrtTreeMarker2;
-    visualization_msgs::Marker finalPath;
+/**
+* warm start: turns the tree of the previous plan into a tree rooted at the new start
+* The node nearest to the start is connected to a new root placed at the
+* start, and the chain from it up to the old root is reversed. The branch
+* through its old parent leads back to where the robot came from and is
+* dropped. The remaining nodes are renumbered breadth first from the new
+* root (so the root is node 0 again), branches whose edge is no longer free
+* are cut off, and costs are recomputed along the way. Nodes already in the
+* goal region seed bestGoalNodeID_.
+* @param checkEdges re-check every edge; not needed after a TreeRepair
+* @return false if the tree cannot be reused and planning has to start from scratch
+*/
+bool RRT::reRootTree(double startX, double startY, double goalX, double goalY, bool checkEdges)
+{
+    int anchor = getNearestNodeID(startX, startY);
+    if(anchor < 0 || !checkIfInsideBoundary(startX, startY) ||
+       !checkIfEdgeOutsideObstacles(startX, startY, getPosX(anchor), getPosY(anchor)))
+        return false;
 
-    initializeMarkers(sourcePoint, goalPoint, randomPoint, rrtTreeMarker, rrtTreeMarker1, rrtTreeMarker2, finalPath);
+    int behind = rrtTree.parent(anchor) == anchor ? -1 : rrtTree.parent(anchor);
 
-    srand(time(NULL));
+    //把从anchor到旧根节点的链反向
+    int prev = anchor, cur = rrtTree.parent(anchor);
+    rrtTree.setParent(anchor, anchor);
+    while(cur != prev)
+    {
+        int next = rrtTree.parent(cur);
+        rrtTree.setParent(cur, prev);
+        if(next == cur)
+            break;
+        prev = cur;
+        cur = next;
+    }
+    int root = rrtTree.add(startX, startY, getTreeSize(), 0);
+    rrtTree.setParent(anchor, root);
+
+    //从新根节点广度优先重新编号，同时剪掉失效的分支并重新计算代价
+    vector<int> order, newID(getTreeSize(), -1);
+    vector<double> newCost;
+    order.push_back(root);
+    newCost.push_back(0);
+    newID[root] = 0;
+    for(int i=0; i<order.size(); i++)
+    {
+        int node = order[i];
+        for(int c=rrtTree.firstChild(node); c>=0; c=rrtTree.nextSibling(c))
+        {
+            if(c == behind || (checkEdges && (!checkIfInsideBoundary(getPosX(c), getPosY(c)) ||
+               !checkIfEdgeOutsideObstacles(getPosX(node), getPosY(node), getPosX(c), getPosY(c)))))
+                continue;
+            newID[c] = order.size();
+            order.push_back(c);
+            newCost.push_back(newCost[i] + getEuclideanDistance(getPosX(node), getPosY(node), getPosX(c), getPosY(c)));
+        }
+    }
 
-    RRT::rrtNode newNode;
+    vector<double> oldX(rrtTree.posX()), oldY(rrtTree.posY());
+    vector<int> oldParent(rrtTree.parent());
+    rrtTree.clear();
+    for(int i=0; i<order.size(); i++)
+    {
+        int node = order[i];
+        rrtTree.add(oldX[node], oldY[node], i == 0 ? 0 : newID[oldParent[node]], newCost[i]);
 
-    initNode(newNode,start);//初始化节点
+        if(i > 0 && getEuclideanDistance(oldX[node], oldY[node], goalX, goalY) < 0.05)
+            addGoalNode(i, goalX, goalY);
+    }
+    return true;
+}
 
-    double rrtStepSize = 0.05;//
+/**
+* hands the remaining tree edges to the visualizer and publishes the final path
+*/
+void RRT::publishFinalPath(const visualization_msgs::Marker &finalPath)
+{
+    if(!visualize_)
+        return;
+    RRT_PROFILE_SCOPE(stats_.profile, VISUALIZATION);
+    visualizer_.flush(true);
+    visualizer_.publish(finalPath);
+}
 
-    vector< vector<int> > rrtPaths;
-    vector<int> path;
-    int rrtPathLimit = 1;
+/**
+* false once ROS shuts down or the background planner cancels the running search
+*/
+bool RRT::keepPlanning() const
+{
+    return rosOk() && !asyncPlanner_.cancelled();
+}
 
-    int shortestPathLength = 9999;
-    int shortestPath = -1;
+/**
+* With async_planning the search runs on the AsyncPlanner thread and this
+* returns the latest plan for the goal right away (or after at most
+* async_wait_time for a new goal). Statistics and diagnostics then describe
+* the last background plan.
+*/
+bool RRT::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,  std::vector<geometry_msgs::PoseStamped>& plan )
+{
+    if(asyncPlanner_.enabled())
+        return asyncPlanner_.request(start, goal, plan, asyncWaitTime_);
+    return planSync(start, goal, plan);
+}
 
-    RRT::rrtNode tempNode;
+/**
+* statistics of the last plan; with async_planning, of the last plan the
+* background thread published, copied under the AsyncPlanner lock because
+* stats_ belongs to the running search
+*/
+RRT::PlanStatistics RRT::getPlanStatistics()
+{
+    if(!asyncPlanner_.enabled())
+        return stats_;
+    PlanStatistics stats;
+    asyncPlanner_.readPublished([this, &stats]() { stats = publishedStats_; });
+    return stats;
+}
 
-    //vector< vector<geometry_msgs::Point> >  obstacleList = getObstacles();
-    bool addNodeResult = false, nodeToGoal = false;
-    std::cout<<"start: "<<start.pose.position.x<<"  "<<start.pose.position.y<<endl;
-    std::cout<<"goal: "<<goal.pose.position.x<<"  "<<goal.pose.position.y<<endl;
-    status=running;
-    while(ros::ok() && status)
-    {
-        double goalX=goal.pose.position.x;
-        double goalY=goal.pose.position.y;
-        if(rrtPaths.size() < rrtPathLimit)
-        {
-            do
-            {
-                generateTempPoint(tempNode,goalX,goalY,costmap_);
-                //std::cout<<"tempnode generated"<<endl;
-                judgeangle1(tempNode);
-            }
-            while(!judgeangle1(tempNode));
-            
-            addNodeResult = addNewPointtoRRT(tempNode,rrtStepSize);//addNewPointtoRRT(myRRT,tempNode,rrtStepSize,obstacleList);
+/**
+* one complete synchronous plan: search, statistics and diagnostics
+*/
+bool RRT::planSync(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,  std::vector<geometry_msgs::PoseStamped>& plan )
+{
+    boost::lock_guard<boost::mutex> lock(planMutex_);
+    stats_ = PlanStatistics();
+    planStart_ = ros::WallTime::now();
+
+    bool found = multiQuery_ ? solveRoadmap(start, goal, plan) : solve(start, goal, plan);
+    stats_.profile.finish();
+
+    stats_.pathFound = found;
+    stats_.planningTime = (ros::WallTime::now() - planStart_).toSec();
+    stats_.nodes = multiQuery_ ? roadmap_.size() : getTreeSize() + (bidirectional_ ? goalTree_.size() : 0);
+    for(int i=1; i<plan.size(); i++)
+        stats_.pathCost += getEuclideanDistance(plan[i-1].pose.position.x, plan[i-1].pose.position.y,
+                                                plan[i].pose.position.x, plan[i].pose.position.y);
+    publishDiagnostics();
+    if(saveTreeSnapshot_ && !multiQuery_ && !treeSnapshotFile_.empty() && getTreeSize() > 0 && !saveTree(treeSnapshotFile_))
+        ROS_WARN("Cannot write the tree snapshot %s", treeSnapshotFile_.c_str());
+    return found;
+}
 
-            if(addNodeResult)
+/**
+* writes rrtTree with the map geometry, goal and seed of the last plan to a tree snapshot file
+*/
+bool RRT::saveTree(const std::string &path) const
+{
+    TreeSnapshot::Metadata metadata;
+    metadata.seed = stats_.seed;
+    metadata.resolution = snapshot_.getResolution();
+    metadata.originX = snapshot_.getOriginX();
+    metadata.originY = snapshot_.getOriginY();
+    metadata.sizeX = snapshot_.getSizeInCellsX();
+    metadata.sizeY = snapshot_.getSizeInCellsY();
+    metadata.goalX = lastGoalX_;
+    metadata.goalY = lastGoalY_;
+    return TreeSnapshot::write(path, rrtTree, metadata);
+}
+
+/**
+* replaces rrtTree with the tree of a snapshot file
+* The snapshot must have been taken on a map of the same geometry. The next
+* plan re-roots the loaded tree at its start and re-checks every edge
+* against the current map instead of growing a tree from scratch, whatever
+* its goal and the reuse_tree setting.
+* @return false if the file cannot be read or belongs to another map
+*/
+bool RRT::loadTree(const std::string &path)
+{
+    boost::lock_guard<boost::mutex> lock(planMutex_);
+    TreeSnapshot file;
+    if(!file.open(path))
+    {
+        ROS_WARN("Cannot load the tree snapshot: %s", file.error().c_str());
+        return false;
+    }
+    const TreeSnapshot::Metadata &metadata = file.metadata();
+    if(metadata.resolution != costmap_->getResolution() || metadata.originX != costmap_->getOriginX() ||
+       metadata.originY != costmap_->getOriginY() || metadata.sizeX != costmap_->getSizeInCellsX() ||
+       metadata.sizeY != costmap_->getSizeInCellsY())
+    {
+        ROS_WARN("The tree snapshot %s was taken on a different map, not loading it", path.c_str());
+        return false;
+    }
+    rrtTree.configureIndex(costmap_->getOriginX(), costmap_->getOriginY(),
+                           costmap_->getSizeInMetersX(), costmap_->getSizeInMetersY(), neighborRadius_);
+    file.load(rrtTree);
+    lastGoalX_ = metadata.goalX;
+    lastGoalY_ = metadata.goalY;
+    treeLoaded_ = true;
+    ROS_INFO("Loaded a tree of %d nodes from %s", rrtTree.size(), path.c_str());
+    return true;
+}
+
+/**
+* publishes the statistics and the phase profile of the last plan as a diagnostic status
+*/
+void RRT::publishDiagnostics()
+{
+    if(!publishDiagnostics_)
+        return;
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = stats_.pathFound ? diagnostic_msgs::DiagnosticStatus::OK : diagnostic_msgs::DiagnosticStatus::WARN;
+    status.name = "rrt_star_planner: " + name_;
+    status.hardware_id = name_;
+    status.message = stats_.pathFound ? "path found" : PlanStatistics::failureReasonName(stats_.failureReason);
+
+    diagnostic_msgs::KeyValue value;
+    value.key = "iterations";          value.value = std::to_string(stats_.iterations);        status.values.push_back(value);
+    value.key = "nodes";               value.value = std::to_string(stats_.nodes);             status.values.push_back(value);
+    value.key = "planning_time";       value.value = std::to_string(stats_.planningTime);      status.values.push_back(value);
+    value.key = "first_solution_time"; value.value = std::to_string(stats_.firstSolutionTime); status.values.push_back(value);
+    value.key = "path_cost";           value.value = std::to_string(stats_.pathCost);          status.values.push_back(value);
+#ifdef RRT_STAR_PROFILING
+    for(int i=0; i<PlanProfiler::PHASE_COUNT; i++)
+    {
+        PlanProfiler::Phase phase = PlanProfiler::Phase(i);
+        value.key = std::string(PlanProfiler::phaseName(phase)) + "_time";
+        value.value = std::to_string(stats_.profile.phaseTime(phase));
+        status.values.push_back(value);
+    }
+    for(int i=0; i<PlanProfiler::COUNTER_COUNT; i++)
+    {
+        PlanProfiler::Counter counter = PlanProfiler::Counter(i);
+        value.key = PlanProfiler::counterName(counter);
+        value.value = std::to_string(stats_.profile.counter(counter));
+        status.values.push_back(value);
+    }
+#endif
+
+    diagnostic_msgs::DiagnosticArray array;
+    array.header.stamp = ros::Time::now();
+    array.status.push_back(status);
+    diagnosticsPub_.publish(array);
+}
+
+const char *RRT::PlanStatistics::failureReasonName(FailureReason reason)
+{
+    static const char *NAMES[] = { "none", "invalid_start", "invalid_goal", "unreachable",
+                                   "iteration_limit", "time_limit", "interrupted" };
+    return NAMES[reason];
+}
+
+/**
+* pre-planning check of the query, before any tree is grown
+* Start and goal have to be on the map and free. With reachability_check they
+* also have to lie in the same connected component of the downsampled free
+* space, which is cached and only recomputed when the costmap changes.
+*/
+bool RRT::checkQuery(double startX, double startY, double goalX, double goalY)
+{
+    if(!checkIfInsideBoundary(startX, startY) || !checkIfOutsideObstacles(startX, startY))
+        return fail(PlanStatistics::INVALID_START);
+    if(!checkIfInsideBoundary(goalX, goalY) || !checkIfOutsideObstacles(goalX, goalY))
+        return fail(PlanStatistics::INVALID_GOAL);
+    if(reachabilityCheck_)
+    {
+        reachability_.update(snapshot_);
+        if(!reachability_.connected(startX, startY, goalX, goalY))
+            return fail(PlanStatistics::UNREACHABLE);
+    }
+    return true;
+}
+
+/**
+* hard limits of every plan: max_iterations (if set) and max_planning_time
+* In anytime mode they end the optimization, otherwise the search fails.
+* @return the limit that was reached, NONE if there is budget left
+*/
+RRT::PlanStatistics::FailureReason RRT::checkBudget(int iterations) const
+{
+    if(maxIterations_ > 0 && iterations >= maxIterations_)
+        return PlanStatistics::ITERATION_LIMIT;
+    if((ros::WallTime::now() - planStart_).toSec() >= maxPlanningTime_)
+        return PlanStatistics::TIME_LIMIT;
+    return PlanStatistics::NONE;
+}
+
+/**
+* records why the plan failed
+* @return false, so callers can return fail(reason)
+*/
+bool RRT::fail(PlanStatistics::FailureReason reason)
+{
+    stats_.failureReason = reason;
+    if(visualize_)
+        visualizer_.flush(true);
+    ROS_WARN("RRT* planner failed after %d iterations: %s", stats_.iterations, PlanStatistics::failureReasonName(reason));
+    return false;
+}
+
+/**
+* records the time the first path to the goal was found
+*/
+void RRT::markSolutionFound()
+{
+    if(stats_.firstSolutionTime < 0)
+        stats_.firstSolutionTime = (ros::WallTime::now() - planStart_).toSec();
+}
+
+/**
+* copies the costmap into the snapshot and brings the footprint masks and
+* the distance field up to date with it
+* Only the cells inside the given box (meters) are copied.
+* @return true if the map or the footprint changed since the last call
+*/
+bool RRT::updateMap(double minX, double minY, double maxX, double maxY)
+{
+    bool changed = false;
+    if(footprintChecking_)
+    {
+        //足迹或分辨率变化时才重新生成掩码
+        if(costmap_ros_)
+            footprint = costmap_ros_->getRobotFootprint();
+        if(footprintMasks_.update(footprint, costmap_->getResolution()))
+        {
+            snapshot_.setLethalOnly(!footprintMasks_.empty());
+            freeSpace_.invalidate();
+            //碰撞检测的标准整体改变，旧树无法局部修复
+            treeRepair_.setMargin(clearance_ + footprintMasks_.circumscribedRadius());
+            freeSpace_.setMargin(clearance_ + footprintMasks_.circumscribedRadius());
+            rrtTree.clear();
+            changed = true;
+        }
+    }
+    //只在复制快照时持有代价地图的锁
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, SNAPSHOT);
+        changed |= snapshot_.update(*costmap_, minX, minY, maxX, maxY);
+    }
+    if(useDistanceField_)
+        distanceField_.update(snapshot_);
+    return changed;
+}
+
+bool RRT::solve(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,  std::vector<geometry_msgs::PoseStamped>& plan )
+{
+
+    plan.clear();
+    //设置了snapshot_margin时只复制起点和终点周围的区域
+    double margin = snapshotMargin_ > 0 ? snapshotMargin_ : numeric_limits<double>::infinity();
+    updateMap(min(start.pose.position.x, goal.pose.position.x) - margin, min(start.pose.position.y, goal.pose.position.y) - margin,
+              max(start.pose.position.x, goal.pose.position.x) + margin, max(start.pose.position.y, goal.pose.position.y) + margin);
+    //动态重规划：记下上次规划后变化的栅格；地图尺寸或原点改变时树无法修复
+    bool mapReset = dynamicReplanning_ && treeRepair_.update(snapshot_) == TreeRepair::RESET;
+
+    //起点或终点无效、两者不连通时直接返回，不生长树
+    if(!checkQuery(start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y))
+    {
+        rrtTree.clear();
+        goalTree_.clear();
+        return false;
+    }
+    if(freeSpaceSampling_)
+    {
+        freeSpace_.update(snapshot_, collisionChecker_, reachabilityCheck_ ? &reachability_ : NULL);
+        freeSpace_.restrictTo(reachabilityCheck_ ? reachability_.component(start.pose.position.x, start.pose.position.y) : -1);
+    }
+
+    //目标不变时沿用上一次的树，在新的起点处重新设置根节点；从快照文件载入的树总是用于下一次规划
+    bool loadedTree = treeLoaded_ && !bidirectional_;
+    treeLoaded_ = false;
+    bool warmStart = (loadedTree || ((reuseTree_ || dynamicReplanning_) && !bidirectional_ && !mapReset &&
+                     getEuclideanDistance(goal.pose.position.x, goal.pose.position.y, lastGoalX_, lastGoalY_) < 1e-3)) &&
+                     getTreeSize() > 0;
+    lastGoalX_ = goal.pose.position.x;
+    lastGoalY_ = goal.pose.position.y;
+    if(!warmStart)
+        rrtTree.clear();
+    rrtTree.configureIndex(snapshot_.getOriginX(), snapshot_.getOriginY(),
+                           snapshot_.getSizeInMetersX(), snapshot_.getSizeInMetersY(), neighborRadius_);
+    //gamma > 2*(1+1/d)^(1/d)*(area/unit ball)^(1/d)，这里用整张地图的面积
+    rrtGamma_ = rrtGammaParam_ > 0 ? rrtGammaParam_ :
+                2 * sqrt(1.5) * sqrt(snapshot_.getSizeInMetersX() * snapshot_.getSizeInMetersY() / PI);
+    bestGoalNodeID_ = -1;
+    bestGoalCost_ = numeric_limits<double>::max();
+    goalNodeIDs_.clear();
+    if(warmStart && dynamicReplanning_ && !loadedTree)
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, REPAIR);
+        int dropped = treeRepair_.repair(rrtTree, collisionChecker_, neighborRadius_);
+        RRT_PROFILE_ADD(stats_.profile, EDGES_INVALIDATED, treeRepair_.invalidatedEdges());
+        RRT_PROFILE_ADD(stats_.profile, NODES_RECONNECTED, treeRepair_.reconnectedNodes());
+        RRT_PROFILE_ADD(stats_.profile, NODES_DROPPED, dropped);
+        ROS_DEBUG("Tree repair: %d edges invalidated, %d nodes reconnected, %d dropped",
+                  treeRepair_.invalidatedEdges(), treeRepair_.reconnectedNodes(), dropped);
+    }
+    //修复后的树已经无碰撞，重设根节点时不必再检查每条边；载入的树是在另一份地图上建的，必须检查
+    if(warmStart && !reRootTree(start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y,
+                                !dynamicReplanning_ || loadedTree))
+    {
+        warmStart = false;
+        rrtTree.clear();
+    }
+    if(visualize_)
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, VISUALIZATION);
+        visualizer_.beginPlan();
+    }
+
+	//defining markers
+    visualization_msgs::Marker sourcePoint;
+    visualization_msgs::Marker goalPoint;
+    visualization_msgs::Marker randomPoint;
+    visualization_msgs::Marker rrtTreeMarker;
+    visualization_msgs::Marker rrtTreeMarker1;
+    visualization_msgs::Marker rrtTreeMarker2;
+    visualization_msgs::Marker finalPath;
+
+    initializeMarkers(sourcePoint, goalPoint, randomPoint, rrtTreeMarker, rrtTreeMarker1, rrtTreeMarker2, finalPath);
+
+    //固定种子时每次规划都从同一个状态开始
+    uint64_t seed = randomSeed_ >= 0 ? uint64_t(randomSeed_) : uint64_t(ros::WallTime::now().toNSec());
+    sampler_.seed(seed);
+    stats_.seed = seed;
+
+    RRT::rrtNode newNode;
+
+    if(!warmStart)
+        initNode(newNode,start);//初始化节点
+
+    double rrtStepSize = rrtStepSize_;
+
+    vector< vector<int> > rrtPaths;
+    vector<int> &path = pathBuffer_;
+    int rrtPathLimit = 1;
+
+    int shortestPathLength = 9999;
+    int shortestPath = -1;
+
+    RRT::rrtNode tempNode;
+
+    //vector< vector<geometry_msgs::Point> >  obstacleList = getObstacles();
+    bool addNodeResult = false, nodeToGoal = false;
+    ROS_DEBUG("start: %f %f, goal: %f %f", start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y);
+    double goalX=goal.pose.position.x;
+    double goalY=goal.pose.position.y;
+
+    int &iterations = stats_.iterations;
+    ros::WallTime planStart = planStart_;
+
+    //沿用的树里已经有到达目标的节点，非anytime模式下直接返回
+    if(warmStart && !anytime_ && bestGoalNodeID_ >= 0)
+    {
+        getRootToEndPath(bestGoalNodeID_, path);
+        rrtPaths.push_back(path);
+        getPlanFromPath(path, start, goal, plan);
+        setFinalPathData(rrtPaths, rrtPaths.size() - 1, finalPath, goalX, goalY);
+        publishFinalPath(finalPath);
+        return true;
+    }
+
+    if(bidirectional_)
+        return solveBidirectional(start, goal, plan, finalPath);
+
+    if(plannerThreads_ > 1)
+    {
+        int goalNodeID = growTreeParallel(goalX, goalY, rrtStepSize, planStart, seed);
+        if(visualize_)
+            visualizer_.flush(true);
+        if(goalNodeID < 0)
+        {
+            PlanStatistics::FailureReason limit = checkBudget(stats_.iterations);
+            return fail(!keepPlanning() || limit == PlanStatistics::NONE ? PlanStatistics::INTERRUPTED : limit);
+        }
+        getRootToEndPath(goalNodeID, path);
+        rrtPaths.push_back(path);
+        getPlanFromPath(path, start, goal, plan);
+        setFinalPathData(rrtPaths, rrtPaths.size() - 1, finalPath, goalX, goalY);
+        publishFinalPath(finalPath);
+        return true;
+    }
+
+    status=running;
+    if(loopHook_)
+        loopHook_(true);
+    while(keepPlanning() && status)
+    {
+        //到达时间或迭代上限时：anytime模式返回目前最优的路径，否则规划失败
+        PlanStatistics::FailureReason limit = (anytime_ || rrtPaths.size() < rrtPathLimit) ? checkBudget(iterations) : PlanStatistics::NONE;
+        if(limit != PlanStatistics::NONE)
+        {
+            status = success;
+            if(loopHook_)
+                loopHook_(false);
+            if(bestGoalNodeID_ < 0)
+                return fail(limit);
+            getRootToEndPath(bestGoalNodeID_, path);
+            rrtPaths.push_back(path);
+            getPlanFromPath(path, start, goal, plan);
+            setFinalPathData(rrtPaths, rrtPaths.size() - 1, finalPath, goalX, goalY);
+            publishFinalPath(finalPath);
+            return true;
+        }
+        iterations++;
+
+        if(anytime_ || rrtPaths.size() < rrtPathLimit)
+        {
+            bool sampleAccepted;
+            int attempts = 0;
+            do
+            {
+                if(informedSampling_ && bestGoalNodeID_ >= 0)
+                    generateInformedPoint(tempNode, getPosX(0), getPosY(0), goalX, goalY, bestGoalCost_);
+                else
+                    generateTempPoint(tempNode,goalX,goalY,snapshot_);
+                //std::cout<<"tempnode generated"<<endl;
+                sampleAccepted = judgeangle1(tempNode);
+                if(!sampleAccepted)
+                    RRT_PROFILE_COUNT(stats_.profile, SAMPLES_REJECTED);
+            }
+            while(!sampleAccepted && ++attempts < MAX_SAMPLE_ATTEMPTS);
+            
+            //连续多次采样都被拒绝时跳过这次迭代，由时间和迭代上限保证循环结束
+            addNodeResult = sampleAccepted && addNewPointtoRRT(tempNode,rrtStepSize);//addNewPointtoRRT(myRRT,tempNode,rrtStepSize,obstacleList);
+            if(sampleAccepted && !addNodeResult)
+                RRT_PROFILE_COUNT(stats_.profile, SAMPLES_REJECTED);
+
+            if(addNodeResult)
             {
+                RRT_PROFILE_COUNT(stats_.profile, NODES_ADDED);
                 // std::cout<<"tempnode accepted"<<endl;
-                addBranchtoRRTTree(rrtTreeMarker,tempNode);//RRT*应该是写在这一行的下一行（先确确实实的加入了新节点，才能由新节点找近邻节点）
+                int nearestNodeID = tempNode.parentID;//addNewPointtoRRT已经把最近节点设为父节点
+                if(visualize_)
+                    visualizer_.addEdge(TreeVisualizer::TREE_EDGE, tempNode.posX, tempNode.posY, getPosX(nearestNodeID), getPosY(nearestNodeID));
                // std::cout<<"tempnode printed"<<endl;
 
 //RRT*核心部分
             //由此启发：是否可以写一个myRRT.getNearestNeighbor?具体函数写在rrt.cpp中
 //重选父节点过程
-                vector<RRT::rrtNode> rrtNeighbor=getNearestNeighbor(tempNode.nodeID);//如果出错，确认这里的tempNode是否是新生成的节点，以及赋值语句的正确性
+                const vector<int> &rrtNeighbor=getNearestNeighborIDs(tempNode.nodeID);//如果出错，确认这里的tempNode是否是新生成的节点，以及赋值语句的正确性
                         //std::cout<<"rrtNeighbor.size= "<<rrtNeighbor.size()<<endl;///////////////////////////////////////////////
-                int nearestNodeID = getNearestNodeID(tempNode.posX,tempNode.posY);
-                RRT::rrtNode nearestNode = getNode(nearestNodeID);
-                RRT::rrtNode q_min=nearestNode;
+                const vector<double> &treeX = rrtTree.posX();
+                const vector<double> &treeY = rrtTree.posY();
+                const vector<double> &treeCost = rrtTree.cost();
+                int q_min=nearestNodeID;
                 double C_min=tempNode.cost;//！！！注意之前还没有任何关于cost的操作,tempNode.cost
+                {
+                RRT_PROFILE_SCOPE(stats_.profile, CHOOSE_PARENT);
                 for(int k=0;k<rrtNeighbor.size();k++)
                 {
-                    if(checkIfInsideBoundary(rrtNeighbor[k]) && checkIfOutsideObstacles(rrtNeighbor[k])\
-                        &&rrtNeighbor[k].cost+\
-                        caldistance(tempNode.posX,tempNode.posY,rrtNeighbor[k].posX,rrtNeighbor[k].posY)<C_min) 
+                    int nb = rrtNeighbor[k];
+                    if(treeCost[nb]+caldistance(tempNode.posX,tempNode.posY,treeX[nb],treeY[nb])<C_min\
+                        && checkIfEdgeOutsideObstacles(stats_.profile, treeX[nb],treeY[nb],tempNode.posX,tempNode.posY)) 
                         {
-                            //if(myRRT.judgeangle(rrtNeighbor[k],rrtNeighbor[k].parentID,rrtNeighbor[k].nodeID,\
-                              tempNode,tempNode.nodeID))
-                              //{
-                                  q_min = rrtNeighbor[k];
-                                  C_min = rrtNeighbor[k].cost+\
-                                  caldistance(tempNode.posX,tempNode.posY,rrtNeighbor[k].posX,rrtNeighbor[k].posY);
-                              //}
+                                  q_min = nb;
+                                  C_min = treeCost[nb]+\
+                                  caldistance(tempNode.posX,tempNode.posY,treeX[nb],treeY[nb]);
                         }
                 }
-                RRTStarprocess1(rrtTreeMarker1,q_min,tempNode);//这里仿照addBranchtoRRTTree写一个新的划线函数,rrtTreeMarker1是新的标记
+                }
+                if(visualize_)
+                    visualizer_.addEdge(TreeVisualizer::PARENT_EDGE, tempNode.posX, tempNode.posY, treeX[q_min], treeY[q_min]);
                 tempNode.cost=C_min;
 
                 //找到问题的原因是：有时候parentID等于nodeID
-                if(tempNode.nodeID!=q_min.nodeID)
-                    tempNode.parentID=q_min.nodeID;//RRT*第一过程核心，重选父节点////////////////////////
+                if(tempNode.nodeID!=q_min)
+                    tempNode.parentID=q_min;//RRT*第一过程核心，重选父节点////////////////////////
 
-                rrtTree.pop_back();
-                rrtTree.push_back(tempNode);//这里tempNode表示新节点，今后RRT×的操作就基于这个新节点
-                //std::cout<<"x坐标和y坐标"<<myRRT.getNode(tempNode.nodeID).posX<<" , "<<myRRT.getNode(tempNode.nodeID).posY<<endl;
-                //std::cout<<"tempNode.nodeID: "<<tempNode.nodeID<<"    tempNode.parentID: "<<tempNode.parentID<<endl;
+                rrtTree.setCost(tempNode.nodeID, tempNode.cost);
+                rrtTree.setParent(tempNode.nodeID, tempNode.parentID);//这里tempNode表示新节点，今后RRT×的操作就基于这个新节点
 
 
 //重布线过程
                 //没有必要重新再找临近节点了，因为每针对一个新节点，在上一过程已经找到了临近节点
-                RRT::rrtNode q_min1=nearestNode;
-                double C_min1=tempNode.cost+caldistance(q_min.posX,q_min.posY,tempNode.posX,tempNode.posY);
+                int q_min1=nearestNodeID;
+                bool rewired=false;
                 
+                {
+                RRT_PROFILE_SCOPE(stats_.profile, REWIRE);
                 for(int k=0;k<rrtNeighbor.size();k++)
                 {
-                        if(checkIfInsideBoundary(rrtNeighbor[k]) && checkIfOutsideObstacles(rrtNeighbor[k])\
-                        &&(tempNode.cost+caldistance(tempNode.posX,tempNode.posY,rrtNeighbor[k].posX,rrtNeighbor[k].posY))\
-                         < rrtNeighbor[k].cost)//在这个过程中只有当rrtNeighbor==tempNode时才满足条件，因此才会出现q_min1==tempNode的情况
+                        int nb = rrtNeighbor[k];
+                        if((tempNode.cost+caldistance(tempNode.posX,tempNode.posY,treeX[nb],treeY[nb]))< treeCost[nb]\
+                         && checkIfEdgeOutsideObstacles(stats_.profile, tempNode.posX,tempNode.posY,treeX[nb],treeY[nb]))//在这个过程中只有当rrtNeighbor==tempNode时才满足条件，因此才会出现q_min1==tempNode的情况
                         {
-                            //if(myRRT.judgeangle(tempNode,tempNode.parentID,tempNode.nodeID,rrtNeighbor[k],rrtNeighbor[k].nodeID))//路径绕不出去的原因在这个角度判断条件
-                            //{
-                                q_min1=rrtNeighbor[k];
-                                C_min1=tempNode.cost+\
-                                caldistance(tempNode.posX,tempNode.posY,rrtNeighbor[k].posX,rrtNeighbor[k].posY);
-                                if(q_min1.nodeID!=tempNode.nodeID)
-                                   setParentID(q_min1.nodeID, tempNode.nodeID);
-                            //}
+                                q_min1=nb;
+                                if(q_min1!=tempNode.nodeID)
+                                {
+                                   rewireNode(q_min1, tempNode.nodeID);//同时更新代价和整棵子树的代价
+                                   rewired=true;
+                                   RRT_PROFILE_COUNT(stats_.profile, REWIRES);
+                                   if(visualize_)
+                                       visualizer_.addEdge(TreeVisualizer::REWIRE_EDGE, tempNode.posX, tempNode.posY, treeX[nb], treeY[nb]);
+                                }
                         }
                 }
-                RRTStarprocess2(rrtTreeMarker2,q_min1,tempNode);
+                }
+                if(rewired && anytime_)
+                    updateBestGoal(goalX, goalY);
 //判断终止
                nodeToGoal = checkNodetoGoal(goalX, goalY,tempNode);
                 //std::cout<<"nodeToGoal的值： "<<nodeToGoal<<endl;
-                if(nodeToGoal)
+                if(nodeToGoal && anytime_)
+                {
+                    //只记录到达目标的最优节点，到时间后再回溯路径
+                    addGoalNode(tempNode.nodeID, goalX, goalY);
+                }
+                else if(nodeToGoal)
                 {
+                    markSolutionFound();
                     //std::cout<<"最后一个点的ID： "<<tempNode.nodeID<<endl;
-                    path = getRootToEndPath(tempNode.nodeID);//path向量是一个包含组成最终路径的节点ID的向量,这里没有goal的ID
+                    getRootToEndPath(tempNode.nodeID, path);//path向量是一个包含组成最终路径的节点ID的向量,这里没有goal的ID
                     rrtPaths.push_back(path);
-                    std::cout<<"New Path Found. Total paths "<<rrtPaths.size()<<endl;
-                    int i=0;
-                    do
-                    {
-                        geometry_msgs::PoseStamped pose=start;
-                        RRT::rrtNode pathNode=getNode(path[i]);
-                        pose.pose.position.x=pathNode.posX;
-                        pose.pose.position.y=pathNode.posY;
-                        plan.push_back(pose);
-                        i++;
-                    }while(path[i]!=tempNode.nodeID);
-                    plan.push_back(goal);
+                    ROS_DEBUG("New Path Found. Total paths %d", int(rrtPaths.size()));
+                    getPlanFromPath(path, start, goal, plan);
                     //ros::Duration(10).sleep();
                     //std::cout<<"got Root Path"<<endl;
                 }
@@ -705,7 +1656,8 @@ bool RRT::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs:
     else //if(rrtPaths.size() >= rrtPathLimit)
         {
             status = success;
-            std::cout<<"Finding Optimal Path"<<endl;
+            if(loopHook_)
+                loopHook_(false);
             
             for(int i=0; i<rrtPaths.size();i++)
             {
@@ -716,15 +1668,726 @@ bool RRT::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs:
                 }
             }
             setFinalPathData(rrtPaths, shortestPath, finalPath, goalX, goalY);//该函数的作用是画出路径
-            rrt_publisher.publish(finalPath);
+            publishFinalPath(finalPath);
             return  true;
         }
-        rrt_publisher.publish(rrtTreeMarker);
-        rrt_publisher.publish(rrtTreeMarker1);
-        rrt_publisher.publish(rrtTreeMarker2);
+        if(visualize_)
+        {
+            RRT_PROFILE_SCOPE(stats_.profile, VISUALIZATION);
+            visualizer_.flush();
+        }
         //ros::spinOnce();
         //ros::Duration(0.01).sleep();
     }
+    if(loopHook_)
+        loopHook_(false);
+    return fail(PlanStatistics::INTERRUPTED);
+}
+
+/**
+* RRT* extension of one tree towards a target point
+* Steers at most stepSize from the nearest node, picks the cheapest
+* collision-free parent among the near neighbors and rewires them through
+* the new node, as in the unidirectional loop.
+* @return id of the new node, -1 if the step collides, leaves the map or the target is already in the tree
+*/
+int RRT::extendTree(NodeStore &tree, double targetX, double targetY, double stepSize)
+{
+    int nearestID;
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, NEAREST);
+        nearestID = tree.nearest(targetX, targetY);
+    }
+    double nearestX = tree.x(nearestID), nearestY = tree.y(nearestID);
+    double distance = caldistance(nearestX, nearestY, targetX, targetY);
+    if(distance < 1e-9)
+        return -1;
+    double newX = targetX, newY = targetY;
+    if(distance > stepSize)
+    {
+        newX = nearestX + (targetX - nearestX) * stepSize / distance;
+        newY = nearestY + (targetY - nearestY) * stepSize / distance;
+    }
+    if(!checkIfInsideBoundary(newX, newY) || !checkIfEdgeOutsideObstacles(stats_.profile, nearestX, nearestY, newX, newY))
+        return -1;
+
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, NEAREST);
+        findNeighbors(tree, newX, newY, -1, neighborIDs_);
+    }
+    int parentID = nearestID;
+    double newCost = tree.cost(nearestID) + caldistance(nearestX, nearestY, newX, newY);
+    {
+        RRT_PROFILE_SCOPE(stats_.profile, CHOOSE_PARENT);
+        for(int k=0; k<neighborIDs_.size(); k++)
+        {
+            int nb = neighborIDs_[k];
+            double viaCost = tree.cost(nb) + caldistance(tree.x(nb), tree.y(nb), newX, newY);
+            if(viaCost < newCost && checkIfEdgeOutsideObstacles(stats_.profile, tree.x(nb), tree.y(nb), newX, newY))
+            {
+                parentID = nb;
+                newCost = viaCost;
+            }
+        }
+    }
+    int nodeID = tree.add(newX, newY, parentID, newCost);
+    RRT_PROFILE_COUNT(stats_.profile, NODES_ADDED);
+    if(visualize_)
+        visualizer_.addEdge(TreeVisualizer::PARENT_EDGE, newX, newY, tree.x(parentID), tree.y(parentID));
+
+    RRT_PROFILE_SCOPE(stats_.profile, REWIRE);
+    for(int k=0; k<neighborIDs_.size(); k++)
+    {
+        int nb = neighborIDs_[k];
+        if(nb != parentID && newCost + caldistance(newX, newY, tree.x(nb), tree.y(nb)) < tree.cost(nb) &&
+           checkIfEdgeOutsideObstacles(stats_.profile, newX, newY, tree.x(nb), tree.y(nb)))
+        {
+            rewireNode(tree, nb, nodeID);
+            RRT_PROFILE_COUNT(stats_.profile, REWIRES);
+            if(visualize_)
+                visualizer_.addEdge(TreeVisualizer::REWIRE_EDGE, newX, newY, tree.x(nb), tree.y(nb));
+        }
+    }
+    return nodeID;
+}
+
+/**
+* greedily extends a tree towards a point until it reaches it or gets blocked
+* @return id of the node placed on the point, -1 if the tree got stuck
+*/
+int RRT::connectTree(NodeStore &tree, double targetX, double targetY, double stepSize)
+{
+    while(true)
+    {
+        int nodeID = extendTree(tree, targetX, targetY, stepSize);
+        if(nodeID < 0)
+            return -1;
+        if(tree.x(nodeID) == targetX && tree.y(nodeID) == targetY)
+            return nodeID;
+    }
+}
+
+/**
+* finds the cheapest of the recorded connections; costs change as both trees are rewired
+* @return index into connections_, -1 if there is none
+*/
+int RRT::updateBestConnection()
+{
+    int best = -1;
+    bestGoalCost_ = numeric_limits<double>::max();
+    for(int i=0; i<connections_.size(); i++)
+    {
+        double cost = rrtTree.cost(connections_[i].first) + goalTree_.cost(connections_[i].second);
+        if(cost < bestGoalCost_)
+        {
+            bestGoalCost_ = cost;
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+* bidirectional RRT*-Connect
+* rrtTree grows from the start and goalTree_ from the goal. Each iteration
+* extends one of them towards a sample (biased towards the other root) and
+* then greedily connects the other tree to the new node; the trees swap roles
+* every iteration. Both are RRT* trees: every extension chooses the cheapest
+* parent and rewires its neighbors. Without anytime the first connection is
+* returned, otherwise the cheapest one when time or iterations run out.
+*/
+bool RRT::solveBidirectional(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                             std::vector<geometry_msgs::PoseStamped>& plan, visualization_msgs::Marker &finalPath)
+{
+    double startX = start.pose.position.x, startY = start.pose.position.y;
+    double goalX = goal.pose.position.x, goalY = goal.pose.position.y;
+    goalTree_.clear();
+    goalTree_.configureIndex(snapshot_.getOriginX(), snapshot_.getOriginY(),
+                             snapshot_.getSizeInMetersX(), snapshot_.getSizeInMetersY(), neighborRadius_);
+    goalTree_.add(goalX, goalY, 0, 0);
+    connections_.clear();
+
+    int &iterations = stats_.iterations;
+    int best = -1;
+    bool fromStart = true;
+    PlanStatistics::FailureReason limit = PlanStatistics::INTERRUPTED;
+    RRT::rrtNode tempNode;
+    if(loopHook_)
+        loopHook_(true);
+    while(keepPlanning())
+    {
+        if(best >= 0 && !anytime_)
+            break;
+        limit = checkBudget(iterations);
+        if(limit != PlanStatistics::NONE)
+            break;
+        limit = PlanStatistics::INTERRUPTED;
+        iterations++;
+
+        NodeStore &tree = fromStart ? rrtTree : goalTree_;
+        NodeStore &other = fromStart ? goalTree_ : rrtTree;
+        fromStart = !fromStart;
+
+        if(informedSampling_ && best >= 0)
+            generateInformedPoint(tempNode, startX, startY, goalX, goalY, bestGoalCost_);
+        else
+            generateTempPoint(tempNode, other.x(0), other.y(0), snapshot_);
+
+        int newID = extendTree(tree, tempNode.posX, tempNode.posY, rrtStepSize_);
+        if(newID < 0)
+        {
+            RRT_PROFILE_COUNT(stats_.profile, SAMPLES_REJECTED);
+            continue;
+        }
+        int otherID = connectTree(other, tree.x(newID), tree.y(newID), rrtStepSize_);
+        if(otherID >= 0)
+        {
+            markSolutionFound();
+            connections_.push_back(&tree == &rrtTree ? make_pair(newID, otherID) : make_pair(otherID, newID));
+            ROS_DEBUG("Trees connected, %d connections", int(connections_.size()));
+        }
+        if(!connections_.empty())
+            best = updateBestConnection();
+        if(visualize_)
+        {
+            RRT_PROFILE_SCOPE(stats_.profile, VISUALIZATION);
+            visualizer_.flush();
+        }
+    }
+    if(loopHook_)
+        loopHook_(false);
+
+    if(best < 0)
+        return fail(limit);
+
+    //起点树从根到连接点，再沿目标树从连接点回到目标点；连接点两棵树各有一个，只取一次
+    int startNode = connections_[best].first, goalNode = connections_[best].second;
+    getRootToEndPath(startNode, pathBuffer_);
+    planX_.clear();
+    planY_.clear();
+    for(int i=0; i<pathBuffer_.size(); i++)
+    {
+        planX_.push_back(rrtTree.x(pathBuffer_[i]));
+        planY_.push_back(rrtTree.y(pathBuffer_[i]));
+    }
+    if(goalNode == 0)
+    {
+        planX_.pop_back();
+        planY_.pop_back();
+    }
+    for(int node=goalTree_.parent(goalNode); node != 0; node=goalTree_.parent(node))
+    {
+        planX_.push_back(goalTree_.x(node));
+        planY_.push_back(goalTree_.y(node));
+    }
+    planX_.push_back(goalX);
+    planY_.push_back(goalY);
+    buildPlan(start, goal, plan);
+
+    if(visualize_)
+    {
+        geometry_msgs::Point point;
+        point.z = 0;
+        finalPath.points.reserve(plan.size());
+        for(int i=0; i<plan.size(); i++)
+        {
+            point.x = plan[i].pose.position.x;
+            point.y = plan[i].pose.position.y;
+            finalPath.points.push_back(point);
+        }
+        publishFinalPath(finalPath);
+    }
+    return true;
+}
+
+/**
+* refreshes the snapshot of the whole map and grows the roadmap towards
+* roadmap_nodes; a changed map or footprint discards the roadmap
+*/
+void RRT::prepareRoadmap(const ros::WallTime &deadline)
+{
+    double inf = numeric_limits<double>::infinity();
+    if(updateMap(-inf, -inf, inf, inf) && roadmap_.size() > 0)
+    {
+        ROS_INFO("The map changed, discarding the roadmap of %d nodes", roadmap_.size());
+        roadmap_.clear();
+    }
+    if(reachabilityCheck_)
+        reachability_.update(snapshot_);
+    if(freeSpaceSampling_)
+    {
+        freeSpace_.update(snapshot_, collisionChecker_, reachabilityCheck_ ? &reachability_ : NULL);
+        freeSpace_.restrictTo(-1);
+    }
+    if(roadmap_.size() == 0)
+    {
+        roadmap_.setBounds(snapshot_.getOriginX(), snapshot_.getOriginY(),
+                           snapshot_.getSizeInMetersX(), snapshot_.getSizeInMetersY());
+        roadmapSampler_.seed(randomSeed_ >= 0 ? uint64_t(randomSeed_) : uint64_t(ros::WallTime::now().toNSec()), 1);
+    }
+    growRoadmap(roadmapNodes_ - roadmap_.size(), deadline);
+}
+
+/**
+* adds up to count free samples to the roadmap, stopping early at the deadline
+* @return number of nodes added
+*/
+int RRT::growRoadmap(int count, const ros::WallTime &deadline)
+{
+    RRT_PROFILE_SCOPE(stats_.profile, ROADMAP);
+    double minx = snapshot_.getOriginX(), maxx = snapshot_.getOriginX() + snapshot_.getSizeInMetersX();
+    double miny = snapshot_.getOriginY(), maxy = snapshot_.getOriginY() + snapshot_.getSizeInMetersY();
+    int added = 0;
+    for(int attempt=0; added < count && attempt < 10 * count; attempt++)
+    {
+        if(attempt % 64 == 0 && (!keepPlanning() || ros::WallTime::now() >= deadline))
+            break;
+        double u, v, x, y;
+        roadmapSampler_.point(u, v);
+        if(freeSpaceSampling_ && !freeSpace_.empty())
+            freeSpace_.sample(u, v, x, y);
+        else
+        {
+            x = minx + u * (maxx - minx);
+            y = miny + v * (maxy - miny);
+        }
+        if(roadmap_.addNode(x, y, collisionChecker_) >= 0)
+            added++;
+    }
+    RRT_PROFILE_ADD(stats_.profile, NODES_ADDED, added);
+    return added;
+}
+
+/**
+* multi_query mode: answers the query from the persistent roadmap
+* Start and goal are linked to nearby roadmap nodes and joined by Dijkstra.
+* While no path is found the roadmap is grown by roadmap_nodes more nodes,
+* up to roadmap_max_nodes or max_planning_time. The roadmap path is then
+* smoothed like a tree path.
+*/
+bool RRT::solveRoadmap(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                       std::vector<geometry_msgs::PoseStamped>& plan)
+{
+    plan.clear();
+    double startX = start.pose.position.x, startY = start.pose.position.y;
+    double goalX = goal.pose.position.x, goalY = goal.pose.position.y;
+    ros::WallTime deadline = planStart_ + ros::WallDuration(maxPlanningTime_);
+    int initialSize = roadmap_.size();
+    prepareRoadmap(deadline);
+    if(!checkQuery(startX, startY, goalX, goalY))
+        return false;
+
+    goalTerminals_.resize(1);
+    roadmap_.connect(startX, startY, collisionChecker_, startTerminal_);
+    roadmap_.connect(goalX, goalY, collisionChecker_, goalTerminals_[0]);
+    double cost = roadmap_.path(startTerminal_, goalTerminals_[0], collisionChecker_, roadmapPath_);
+    //路图中没有路径时继续加密路图，直到节点数上限或时间用完
+    while(cost == numeric_limits<double>::infinity() && roadmap_.size() < roadmapMaxNodes_ &&
+          keepPlanning() && ros::WallTime::now() < deadline)
+    {
+        if(growRoadmap(min(roadmapNodes_, roadmapMaxNodes_ - roadmap_.size()), deadline) == 0)
+            break;
+        roadmap_.connect(startX, startY, collisionChecker_, startTerminal_);
+        roadmap_.connect(goalX, goalY, collisionChecker_, goalTerminals_[0]);
+        cost = roadmap_.path(startTerminal_, goalTerminals_[0], collisionChecker_, roadmapPath_);
+    }
+    stats_.iterations = max(0, roadmap_.size() - initialSize);
+    if(cost == numeric_limits<double>::infinity())
+    {
+        if(!keepPlanning())
+            return fail(PlanStatistics::INTERRUPTED);
+        return fail(ros::WallTime::now() >= deadline ? PlanStatistics::TIME_LIMIT : PlanStatistics::ITERATION_LIMIT);
+    }
+    markSolutionFound();
+
+    planX_.clear();
+    planY_.clear();
+    planX_.push_back(startX);
+    planY_.push_back(startY);
+    for(int i=0; i<roadmapPath_.size(); i++)
+    {
+        planX_.push_back(roadmap_.x(roadmapPath_[i]));
+        planY_.push_back(roadmap_.y(roadmapPath_[i]));
+    }
+    planX_.push_back(goalX);
+    planY_.push_back(goalY);
+    buildPlan(start, goal, plan);
+    return true;
+}
+
+/**
+* batch query for dispatching: path lengths from every start to every goal
+* costs[i][j] is the roadmap distance from starts[i] to goals[j], before
+* smoothing, or infinity if no path was found. The roadmap is shared with
+* multi_query plans and grown the same way while some pair that the
+* reachability map considers connected is still without a path. One
+* Dijkstra search per start yields its whole row.
+* @return false if the planner is not initialized
+*/
+bool RRT::makeCostMatrix(const std::vector<geometry_msgs::PoseStamped> &starts,
+                         const std::vector<geometry_msgs::PoseStamped> &goals,
+                         std::vector< std::vector<double> > &costs)
+{
+    if(!initialized_)
+    {
+        ROS_ERROR("The planner has not been initialized, call initialize() first");
+        return false;
+    }
+    boost::lock_guard<boost::mutex> lock(planMutex_);
+    const double INF = numeric_limits<double>::infinity();
+    ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(maxPlanningTime_);
+    prepareRoadmap(deadline);
+    costs.assign(starts.size(), vector<double>(goals.size(), INF));
+
+    vector<char> goalFree(goals.size());
+    while(true)
+    {
+        goalTerminals_.resize(goals.size());
+        for(int j=0; j<goals.size(); j++)
+            goalFree[j] = roadmap_.connect(goals[j].pose.position.x, goals[j].pose.position.y, collisionChecker_, goalTerminals_[j]);
+
+        //只有降采样地图上连通、路图中却还没有路径的起终点对才值得继续加密路图
+        bool missing = false;
+        for(int i=0; i<starts.size(); i++)
+        {
+            double startX = starts[i].pose.position.x, startY = starts[i].pose.position.y;
+            if(!roadmap_.connect(startX, startY, collisionChecker_, startTerminal_))
+                continue;
+            roadmap_.costs(startTerminal_, goalTerminals_, collisionChecker_, costs[i]);
+            for(int j=0; j<goals.size(); j++)
+            {
+                if(costs[i][j] == INF && goalFree[j] && (!reachabilityCheck_ ||
+                   reachability_.connected(startX, startY, goals[j].pose.position.x, goals[j].pose.position.y)))
+                    missing = true;
+            }
+        }
+        if(!missing || roadmap_.size() >= roadmapMaxNodes_ || !keepPlanning() || ros::WallTime::now() >= deadline)
+            break;
+        if(growRoadmap(min(roadmapNodes_, roadmapMaxNodes_ - roadmap_.size()), deadline) == 0)
+            break;
+    }
+    return true;
+}
+
+/**
+* state shared by the workers of growTreeParallel
+* Queries read the tree without a lock (see NodeStore). Only changes to the
+* tree, the goal nodes and the visualizer buffers are serialized by
+* writeMutex; the best goal cost is republished to the samplers through
+* bestCost. The stop flag and iteration counter are atomics.
+* Appends never move the tree arrays while they fit the reserved capacity.
+* When the tree is full, the writer raises growing and reallocates only
+* after every other worker has left its read section; each worker marks
+* its read sections in its own flag, so readers share no written cache line.
+*/
+struct RRT::ParallelContext
+{
+    struct ReadFlag
+    {
+        std::atomic<bool> active;
+        char padding[64 - sizeof(std::atomic<bool>)];
+    };
+
+    boost::mutex writeMutex;
+    std::atomic<bool> stop;
+    std::atomic<int> iterations;
+    std::atomic<double> bestCost;   // max() until a goal node is known
+    std::atomic<bool> growing;
+    boost::scoped_array<ReadFlag> reading;
+    int workers;
+    int goalNodeID;
+    uint64_t seed;
+    double rootX, rootY, goalX, goalY, rrtStepSize;
+    ros::WallTime planStart;
+
+    void beginRead(int worker)
+    {
+        while(true)
+        {
+            reading[worker].active = true;
+            if(!growing)
+                return;
+            reading[worker].active = false;
+            while(growing)
+                boost::this_thread::yield();
+        }
+    }
+
+    void endRead(int worker)
+    {
+        reading[worker].active.store(false, std::memory_order_release);
+    }
+
+    /** called with writeMutex held */
+    void grow(NodeStore &tree)
+    {
+        growing = true;
+        for(int i=0; i<workers; i++)
+        {
+            while(reading[i].active)
+                boost::this_thread::yield();
+        }
+        tree.reserve(2 * tree.capacity());
+        growing = false;
+    }
+};
+
+/**
+* grows the tree with planner_threads workers sharing one tree
+* @return id of the goal node to backtrack from, -1 if none was reached
+*/
+int RRT::growTreeParallel(double goalX, double goalY, double rrtStepSize, ros::WallTime planStart, uint64_t seed)
+{
+    ParallelContext ctx;
+    ctx.stop = false;
+    ctx.iterations = 0;
+    ctx.bestCost = bestGoalNodeID_ >= 0 ? bestGoalCost_ : numeric_limits<double>::max();
+    ctx.goalNodeID = -1;
+    ctx.rootX = getPosX(0);
+    ctx.rootY = getPosY(0);
+    ctx.goalX = goalX;
+    ctx.goalY = goalY;
+    ctx.rrtStepSize = rrtStepSize;
+    ctx.planStart = planStart;
+    ctx.seed = seed;
+    ctx.growing = false;
+    ctx.workers = plannerThreads_;
+    ctx.reading.reset(new ParallelContext::ReadFlag[plannerThreads_]);
+    for(int i=0; i<plannerThreads_; i++)
+        ctx.reading[i].active = false;
+
+    boost::thread_group workers;
+    for(int i=0; i<plannerThreads_; i++)
+        workers.create_thread(boost::bind(&RRT::parallelWorker, this, &ctx, i + 1));
+    workers.join_all();
+    stats_.iterations = ctx.iterations;
+    //等待线程的时间不计入，各线程自己的统计已经合并进来
+    stats_.profile.discard();
+
+    return anytime_ ? bestGoalNodeID_ : ctx.goalNodeID;
+}
+
+/**
+* one worker of the parallel planner
+* Sampling, steering, the nearest and near-neighbor queries and every
+* collision check run without a lock. The neighbors' positions and costs are
+* copied into a snapshot; choose-parent and the rewire candidates are decided
+* on it and re-validated against the current costs under the write lock
+* when the node is inserted. Nodes published by other workers in the
+* meantime are simply not considered for this sample.
+*/
+void RRT::parallelWorker(ParallelContext *ctx, unsigned int stream)
+{
+    int worker = stream - 1;
+    Sampler sampler;
+    sampler.seed(ctx->seed, stream);
+    sampler.setSequence(sampleSequence_);
+    PlanProfiler profiler;
+    vector<int> neighbors, order;
+    vector<double> nbX, nbY, nbCost, viaCost;
+    vector<char> rewire;
+    neighbors.reserve(256);
+    order.reserve(256);
+    nbX.reserve(256);
+    nbY.reserve(256);
+    nbCost.reserve(256);
+    viaCost.reserve(256);
+    rewire.reserve(256);
+
+    double minx = snapshot_.getOriginX(), maxx = snapshot_.getOriginX() + snapshot_.getSizeInMetersX();
+    double miny = snapshot_.getOriginY(), maxy = snapshot_.getOriginY() + snapshot_.getSizeInMetersY();
+    double rootX = ctx->rootX, rootY = ctx->rootY;
+    bool hasBest = false;
+    double bestCost = 0;
+
+    while(!ctx->stop && keepPlanning())
+    {
+        int iteration = ++ctx->iterations;
+        if((maxIterations_ > 0 && iteration > maxIterations_) ||
+           (ros::WallTime::now() - ctx->planStart).toSec() >= maxPlanningTime_)
+        {
+            ctx->stop = true;
+            break;
+        }
+
+        //采样，和generateTempPoint / generateInformedPoint相同
+        double sx, sy;
+        {
+        RRT_PROFILE_SCOPE(profiler, SAMPLING);
+        RRT_PROFILE_COUNT(profiler, SAMPLES_DRAWN);
+        if(informedSampling_ && hasBest)
+        {
+            double minCost = getEuclideanDistance(rootX, rootY, ctx->goalX, ctx->goalY);
+            double a = bestCost / 2;
+            double b = bestCost > minCost ? sqrt(bestCost * bestCost - minCost * minCost) / 2 : 0;
+            double theta = atan2(ctx->goalY - rootY, ctx->goalX - rootX);
+            double r = sqrt(sampler.uniform()), phi = 2 * PI * sampler.uniform();
+            double ex = a * r * cos(phi), ey = b * r * sin(phi);
+            sx = (rootX + ctx->goalX) / 2 + ex * cos(theta) - ey * sin(theta);
+            sy = (rootY + ctx->goalY) / 2 + ex * sin(theta) + ey * cos(theta);
+        }
+        else if(sampler.uniform() < 0.2)
+        {
+            sx = ctx->goalX;
+            sy = ctx->goalY;
+        }
+        else
+        {
+            double u, v;
+            sampler.point(u, v);
+            if(freeSpaceSampling_ && !freeSpace_.empty())
+                freeSpace_.sample(u, v, sx, sy);
+            else
+            {
+                sx = u * (maxx - minx) + minx;
+                sy = v * (maxy - miny) + miny;
+            }
+        }
+        }
+
+        int nearestID;
+        double nearestX, nearestY;
+        {
+            RRT_PROFILE_SCOPE(profiler, NEAREST);
+            ctx->beginRead(worker);
+            nearestID = rrtTree.nearest(sx, sy);
+            nearestX = rrtTree.x(nearestID);
+            nearestY = rrtTree.y(nearestID);
+            ctx->endRead(worker);
+            bestCost = ctx->bestCost;
+            hasBest = bestCost < numeric_limits<double>::max();
+        }
+        if(sx == nearestX && sy == nearestY)
+        {
+            RRT_PROFILE_COUNT(profiler, SAMPLES_REJECTED);
+            continue;
+        }
+
+        double theta = atan2(sy - nearestY, sx - nearestX);
+        double px = nearestX + ctx->rrtStepSize * cos(theta);
+        double py = nearestY + ctx->rrtStepSize * sin(theta);
+        if(!checkIfInsideBoundary(px, py) || !checkIfEdgeOutsideObstacles(profiler, nearestX, nearestY, px, py))
+        {
+            RRT_PROFILE_COUNT(profiler, SAMPLES_REJECTED);
+            continue;
+        }
+
+        {
+            RRT_PROFILE_SCOPE(profiler, NEAREST);
+            ctx->beginRead(worker);
+            findNeighbors(px, py, -1, neighbors);
+            nbX.resize(neighbors.size());
+            nbY.resize(neighbors.size());
+            nbCost.resize(neighbors.size());
+            for(int k=0; k<neighbors.size(); k++)
+            {
+                nbX[k] = rrtTree.x(neighbors[k]);
+                nbY[k] = rrtTree.y(neighbors[k]);
+                nbCost[k] = rrtTree.cost(neighbors[k]);
+            }
+            ctx->endRead(worker);
+        }
+
+        //重选父节点：按经过邻居的代价排序，第一个无碰撞的邻居就是最优父节点
+        int parentID = nearestID;
+        double newCost = numeric_limits<double>::max();
+        {
+        RRT_PROFILE_SCOPE(profiler, CHOOSE_PARENT);
+        viaCost.resize(neighbors.size());
+        order.resize(neighbors.size());
+        for(int k=0; k<neighbors.size(); k++)
+        {
+            viaCost[k] = nbCost[k] + caldistance(px, py, nbX[k], nbY[k]);
+            order[k] = k;
+        }
+        std::sort(order.begin(), order.end(), [&viaCost](int l, int r) { return viaCost[l] < viaCost[r]; });
+        for(int k=0; k<order.size(); k++)
+        {
+            int nb = order[k];
+            if(neighbors[nb] == nearestID || checkIfEdgeOutsideObstacles(profiler, nbX[nb], nbY[nb], px, py))
+            {
+                parentID = neighbors[nb];
+                break;
+            }
+        }
+        for(int k=0; k<neighbors.size(); k++)
+        {
+            if(neighbors[k] == parentID)
+                newCost = viaCost[k];
+        }
+        }
+        //最近节点不在邻居快照里时（例如被k近邻或max_neighbors截掉）没有可比较的代价，放弃这个采样
+        if(newCost == numeric_limits<double>::max())
+        {
+            RRT_PROFILE_COUNT(profiler, SAMPLES_REJECTED);
+            continue;
+        }
+
+        //重布线候选：碰撞检测在锁外完成
+        RRT_PROFILE_SCOPE(profiler, REWIRE);
+        rewire.assign(neighbors.size(), 0);
+        for(int k=0; k<neighbors.size(); k++)
+        {
+            if(neighbors[k] != parentID && newCost + caldistance(px, py, nbX[k], nbY[k]) < nbCost[k] &&
+               checkIfEdgeOutsideObstacles(profiler, px, py, nbX[k], nbY[k]))
+                rewire[k] = 1;
+        }
+
+        boost::lock_guard<boost::mutex> lock(ctx->writeMutex);
+        if(ctx->stop)
+            break;
+        if(rrtTree.size() == rrtTree.capacity())
+            ctx->grow(rrtTree);
+        newCost = rrtTree.cost(parentID) + caldistance(px, py, rrtTree.x(parentID), rrtTree.y(parentID));
+        RRT::rrtNode tempNode;
+        tempNode.posX = px;
+        tempNode.posY = py;
+        tempNode.parentID = parentID;
+        tempNode.cost = newCost;
+        tempNode.nodeID = rrtTree.add(px, py, parentID, newCost);
+        RRT_PROFILE_COUNT(profiler, NODES_ADDED);
+        bool rewired = false;
+        if(visualize_)
+        {
+            visualizer_.addEdge(TreeVisualizer::TREE_EDGE, px, py, nearestX, nearestY);
+            visualizer_.addEdge(TreeVisualizer::PARENT_EDGE, px, py, rrtTree.x(parentID), rrtTree.y(parentID));
+        }
+
+        for(int k=0; k<neighbors.size(); k++)
+        {
+            int nb = neighbors[k];
+            if(rewire[k] && newCost + caldistance(px, py, nbX[k], nbY[k]) < rrtTree.cost(nb))
+            {
+                rewireNode(nb, tempNode.nodeID);
+                rewired = true;
+                RRT_PROFILE_COUNT(profiler, REWIRES);
+                if(visualize_)
+                    visualizer_.addEdge(TreeVisualizer::REWIRE_EDGE, px, py, nbX[k], nbY[k]);
+            }
+        }
+        if(rewired && anytime_)
+            updateBestGoal(ctx->goalX, ctx->goalY);
+        if(visualize_)
+            visualizer_.flush();
+
+        if(checkNodetoGoal(ctx->goalX, ctx->goalY, tempNode))
+        {
+            if(anytime_)
+                addGoalNode(tempNode.nodeID, ctx->goalX, ctx->goalY);
+            else
+            {
+                ctx->goalNodeID = tempNode.nodeID;
+                markSolutionFound();
+                ctx->stop = true;
+            }
+        }
+        if(anytime_)
+            ctx->bestCost = bestGoalNodeID_ >= 0 ? bestGoalCost_ : numeric_limits<double>::max();
+    }
+
+    profiler.finish();
+    boost::lock_guard<boost::mutex> lock(ctx->writeMutex);
+    stats_.profile.merge(profiler);
 }
 }
 
@@ -0,0 +1,156 @@
+#include <rrt_star_planner/sampler.h>
+
+namespace rrtstar_planner{
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline double toUnit(uint64_t x)
+{
+    return (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+* radical inverse in base 2: the bits of the index mirrored behind the binary point
+*/
+static inline double radicalInverse2(uint32_t i)
+{
+    i = (i << 16) | (i >> 16);
+    i = ((i & 0x00ff00ffu) << 8) | ((i & 0xff00ff00u) >> 8);
+    i = ((i & 0x0f0f0f0fu) << 4) | ((i & 0xf0f0f0f0u) >> 4);
+    i = ((i & 0x33333333u) << 2) | ((i & 0xccccccccu) >> 2);
+    i = ((i & 0x55555555u) << 1) | ((i & 0xaaaaaaaau) >> 1);
+    return i * (1.0 / 4294967296.0);
+}
+
+static inline double radicalInverse3(uint32_t i)
+{
+    double result = 0, scale = 1.0 / 3;
+    while(i > 0)
+    {
+        result += (i % 3) * scale;
+        i /= 3;
+        scale /= 3;
+    }
+    return result;
+}
+
+Sampler::Sampler()
+    : next_(BATCH), sequence_(UNIFORM), nextPoint_(BATCH), haltonIndex_(1), shiftU_(0), shiftV_(0)
+{
+    seed(0);
+}
+
+/**
+* restarts the generator
+* The state is expanded from the seed with splitmix64, then advanced by
+* 2^128 numbers per stream, so threads seeded with the same seed and
+* different streams never share numbers.
+*/
+void Sampler::seed(uint64_t seed, unsigned int stream)
+{
+    for(int i=0; i<4; i++)
+    {
+        seed += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        state_[i] = z ^ (z >> 31);
+    }
+    for(unsigned int s=0; s<stream; s++)
+        jump();
+    next_ = BATCH;
+    nextPoint_ = BATCH;
+    haltonIndex_ = 1;
+    shiftU_ = toUnit(nextRaw());
+    shiftV_ = toUnit(nextRaw());
+}
+
+void Sampler::setSequence(Sequence sequence)
+{
+    sequence_ = sequence;
+    nextPoint_ = BATCH;
+}
+
+/**
+* next point of the unit square, from the PRNG or the shifted Halton sequence
+*/
+void Sampler::point(double &u, double &v)
+{
+    if(sequence_ == UNIFORM)
+    {
+        u = uniform();
+        v = uniform();
+        return;
+    }
+    if(nextPoint_ == BATCH)
+        refillPoints();
+    u = points_[nextPoint_];
+    v = points_[nextPoint_ + 1];
+    nextPoint_ += 2;
+}
+
+uint64_t Sampler::nextRaw()
+{
+    const uint64_t result = state_[0] + state_[3];
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+}
+
+/**
+* advances the state by 2^128 numbers
+*/
+void Sampler::jump()
+{
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                     0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for(int i=0; i<4; i++)
+    {
+        for(int b=0; b<64; b++)
+        {
+            if(JUMP[i] & (uint64_t(1) << b))
+            {
+                s0 ^= state_[0];
+                s1 ^= state_[1];
+                s2 ^= state_[2];
+                s3 ^= state_[3];
+            }
+            nextRaw();
+        }
+    }
+    state_[0] = s0;
+    state_[1] = s1;
+    state_[2] = s2;
+    state_[3] = s3;
+}
+
+void Sampler::refill()
+{
+    for(int i=0; i<BATCH; i++)
+        batch_[i] = toUnit(nextRaw());
+    next_ = 0;
+}
+
+void Sampler::refillPoints()
+{
+    for(int i=0; i<BATCH; i+=2)
+    {
+        double u = radicalInverse2(haltonIndex_) + shiftU_;
+        double v = radicalInverse3(haltonIndex_) + shiftV_;
+        points_[i] = u >= 1 ? u - 1 : u;
+        points_[i + 1] = v >= 1 ? v - 1 : v;
+        haltonIndex_++;
+    }
+    nextPoint_ = 0;
+}
+
+}
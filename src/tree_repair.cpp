@@ -0,0 +1,262 @@
+#include <rrt_star_planner/tree_repair.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+    // costmap cells per side of an index bucket
+    static const int BUCKET_CELLS = 8;
+
+    enum NodeState { VALID = 0, CHECKED, ORPHAN, ATTACHED };
+
+TreeRepair::TreeRepair()
+    : sizeX_(0), sizeY_(0), stride_(0), resolution_(0), originX_(0), originY_(0), margin_(0), marginCells_(1),
+      bucketsX_(0), bucketsY_(0), anyDirty_(false), invalidated_(0), reconnected_(0)
+{
+
+}
+
+/**
+* sets how far (in meters) from a changed cell an edge can be affected,
+* i.e. the clearance plus the circumscribed radius of the footprint
+*/
+void TreeRepair::setMargin(double margin)
+{
+    margin_ = margin;
+    if(resolution_ > 0)
+        marginCells_ = int(ceil(margin_ / resolution_)) + 1;
+}
+
+/**
+* compares the map snapshot with the copy from the previous call and marks
+* the buckets around changed cells dirty
+* @return RESET if the costmap was resized or moved, so the tree cannot be repaired
+*/
+TreeRepair::MapChange TreeRepair::update(const CostmapSnapshot &map)
+{
+    unsigned int sx = map.getSizeInCellsX(), sy = map.getSizeInCellsY();
+    int stride = map.stride();
+    anyDirty_ = false;
+    if(sx != sizeX_ || sy != sizeY_ || map.getResolution() != resolution_ ||
+       map.getOriginX() != originX_ || map.getOriginY() != originY_ || lastBits_.size() != size_t(stride) * sy)
+    {
+        sizeX_ = sx;
+        sizeY_ = sy;
+        stride_ = stride;
+        resolution_ = map.getResolution();
+        originX_ = map.getOriginX();
+        originY_ = map.getOriginY();
+        setMargin(margin_);
+        lastBits_.resize(size_t(stride) * sy);
+        for(unsigned int y=0; y<sy; y++)
+            memcpy(&lastBits_[y * stride], map.row(y), stride * sizeof(uint64_t));
+        bucketsX_ = (sx + BUCKET_CELLS - 1) / BUCKET_CELLS;
+        bucketsY_ = (sy + BUCKET_CELLS - 1) / BUCKET_CELLS;
+        dirty_.assign(bucketsX_ * bucketsY_, 0);
+        return RESET;
+    }
+
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    for(unsigned int y=0; y<sy; y++)
+    {
+        const uint64_t* row = map.row(y);
+        uint64_t* last = &lastBits_[y * stride];
+        if(memcmp(row, last, stride * sizeof(uint64_t)) == 0)
+            continue;
+        //异或结果的首尾置位即为变化范围的首尾栅格
+        int first = 0, end = stride - 1;
+        while(row[first] == last[first])
+            first++;
+        while(row[end] == last[end])
+            end--;
+        int x0 = first * 64 + __builtin_ctzll(row[first] ^ last[first]);
+        int x1 = end * 64 + 63 - __builtin_clzll(row[end] ^ last[end]);
+        markDirty(x0, min(x1, int(sx) - 1), y);
+        memcpy(last, row, stride * sizeof(uint64_t));
+    }
+    return anyDirty_ ? CHANGED : UNCHANGED;
+}
+
+/**
+* marks the buckets within the margin of the changed cells [x0,x1] of row y
+*/
+void TreeRepair::markDirty(int x0, int x1, int y)
+{
+    int bx0 = max(0, x0 - marginCells_) / BUCKET_CELLS, bx1 = min(int(sizeX_) - 1, x1 + marginCells_) / BUCKET_CELLS;
+    int by0 = max(0, y - marginCells_) / BUCKET_CELLS, by1 = min(int(sizeY_) - 1, y + marginCells_) / BUCKET_CELLS;
+    for(int by=by0; by<=by1; by++)
+        for(int bx=bx0; bx<=bx1; bx++)
+            dirty_[by * bucketsX_ + bx] = 1;
+    anyDirty_ = true;
+}
+
+/**
+* bucket holding a point, clamped to the map
+*/
+int TreeRepair::bucketOf(double X, double Y, int &bx, int &by) const
+{
+    int cx = min(max(int(floor((X - originX_) / resolution_)), 0), int(sizeX_) - 1);
+    int cy = min(max(int(floor((Y - originY_) / resolution_)), 0), int(sizeY_) - 1);
+    bx = cx / BUCKET_CELLS;
+    by = cy / BUCKET_CELLS;
+    return by * bucketsX_ + bx;
+}
+
+/**
+* lists every edge (by its child node) in each bucket of its bounding box
+*/
+void TreeRepair::indexEdges(const NodeStore &tree)
+{
+    head_.assign(bucketsX_ * bucketsY_, -1);
+    entryNode_.clear();
+    entryNext_.clear();
+    for(int node=0; node<tree.size(); node++)
+    {
+        int p = tree.parent(node);
+        if(p == node)
+            continue;
+        int ax, ay, bx, by;
+        bucketOf(tree.x(node), tree.y(node), ax, ay);
+        bucketOf(tree.x(p), tree.y(p), bx, by);
+        for(int y=min(ay, by); y<=max(ay, by); y++)
+        {
+            for(int x=min(ax, bx); x<=max(ax, bx); x++)
+            {
+                int b = y * bucketsX_ + x;
+                entryNode_.push_back(node);
+                entryNext_.push_back(head_[b]);
+                head_[b] = entryNode_.size() - 1;
+            }
+        }
+    }
+}
+
+void TreeRepair::push(double cost, int node, int parent)
+{
+    key_[node] = cost;
+    Candidate candidate;
+    candidate.cost = cost;
+    candidate.node = node;
+    candidate.parent = parent;
+    heap_.push_back(candidate);
+    push_heap(heap_.begin(), heap_.end());
+}
+
+/**
+* cuts the tree edges blocked since the last update() and reconnects the orphaned subtrees
+* Must follow update() and the distance field update, and expects node 0 to be the root.
+* @param radius neighborhood searched for new parents of orphaned nodes
+* @return number of nodes dropped because they could not be reconnected
+*/
+int TreeRepair::repair(NodeStore &tree, const CollisionChecker &checker, double radius)
+{
+    invalidated_ = reconnected_ = 0;
+    int n = tree.size();
+    if(!anyDirty_ || n == 0)
+        return 0;
+
+    //只重新检查经过变化区域的边
+    indexEdges(tree);
+    state_.assign(n, VALID);
+    orphans_.clear();
+    for(int b=0; b<dirty_.size(); b++)
+    {
+        if(!dirty_[b])
+            continue;
+        for(int e=head_[b]; e>=0; e=entryNext_[e])
+        {
+            int node = entryNode_[e];
+            if(state_[node] != VALID)
+                continue;
+            state_[node] = CHECKED;
+            int p = tree.parent(node);
+            if(!checker.segmentFree(tree.x(p), tree.y(p), tree.x(node), tree.y(node)))
+                orphans_.push_back(node);
+        }
+    }
+    invalidated_ = orphans_.size();
+    if(orphans_.empty())
+        return 0;
+
+    //剪断失效的边，被剪下的子树全部成为孤儿节点
+    stack_.clear();
+    for(int i=0; i<orphans_.size(); i++)
+    {
+        tree.setParent(orphans_[i], orphans_[i]);
+        stack_.push_back(orphans_[i]);
+    }
+    orphans_.clear();
+    while(!stack_.empty())
+    {
+        int node = stack_.back();
+        stack_.pop_back();
+        state_[node] = ORPHAN;
+        orphans_.push_back(node);
+        for(int c=tree.firstChild(node); c>=0; c=tree.nextSibling(c))
+            stack_.push_back(c);
+    }
+
+    //每个孤儿节点先找树中代价最小的无碰撞邻居
+    key_.assign(n, numeric_limits<double>::max());
+    heap_.clear();
+    for(int i=0; i<orphans_.size(); i++)
+    {
+        int node = orphans_[i];
+        double X = tree.x(node), Y = tree.y(node);
+        tree.radius(X, Y, radius, neighbors_);
+        sort(neighbors_.begin(), neighbors_.end(), [&](int l, int r)
+        {
+            return tree.cost(l) + hypot(tree.x(l) - X, tree.y(l) - Y) < tree.cost(r) + hypot(tree.x(r) - X, tree.y(r) - Y);
+        });
+        for(int k=0; k<neighbors_.size(); k++)
+        {
+            int nb = neighbors_[k];
+            if(state_[nb] < ORPHAN && checker.segmentFree(tree.x(nb), tree.y(nb), X, Y))
+            {
+                push(tree.cost(nb) + hypot(tree.x(nb) - X, tree.y(nb) - Y), node, nb);
+                break;
+            }
+        }
+    }
+
+    //按代价从小到大接回孤儿节点，接回的节点再作为其子节点和孤儿邻居的父节点候选
+    while(!heap_.empty())
+    {
+        pop_heap(heap_.begin(), heap_.end());
+        Candidate best = heap_.back();
+        heap_.pop_back();
+        int node = best.node;
+        if(state_[node] != ORPHAN || best.cost > key_[node])
+            continue;
+        tree.setParent(node, best.parent);
+        tree.setCost(node, best.cost);
+        state_[node] = ATTACHED;
+        reconnected_++;
+
+        double X = tree.x(node), Y = tree.y(node);
+        for(int c=tree.firstChild(node); c>=0; c=tree.nextSibling(c))
+        {
+            double via = best.cost + hypot(tree.x(c) - X, tree.y(c) - Y);
+            if(state_[c] == ORPHAN && via < key_[c])
+                push(via, c, node);
+        }
+        tree.radius(X, Y, radius, neighbors_);
+        for(int k=0; k<neighbors_.size(); k++)
+        {
+            int nb = neighbors_[k];
+            if(state_[nb] != ORPHAN || tree.parent(nb) == node)
+                continue;
+            double via = best.cost + hypot(tree.x(nb) - X, tree.y(nb) - Y);
+            if(via < key_[nb] && checker.segmentFree(X, Y, tree.x(nb), tree.y(nb)))
+                push(via, nb, node);
+        }
+    }
+
+    return tree.prune(newID_);
+}
+
+}
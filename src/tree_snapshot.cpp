@@ -0,0 +1,167 @@
+#include <rrt_star_planner/tree_snapshot.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+    static const char MAGIC[8] = { 'R', 'R', 'T', 'T', 'R', 'E', 'E', 0 };
+
+TreeSnapshot::TreeSnapshot()
+    : data_(NULL), bytes_(0), size_(0), x_(NULL), y_(NULL), cost_(NULL), parent_(NULL)
+{
+
+}
+
+TreeSnapshot::~TreeSnapshot()
+{
+    close();
+}
+
+/**
+* writes the tree and what it was planned on to path
+* @return false if the tree is empty or the file could not be written; an
+* existing file is then left untouched
+*/
+bool TreeSnapshot::write(const std::string &path, const NodeStore &tree, const Metadata &metadata)
+{
+    if(tree.size() == 0)
+        return false;
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerBytes = sizeof(Header);
+    header.nodeCount = tree.size();
+    header.metadata = metadata;
+
+    int n = tree.size();
+    vector<int32_t> parent(tree.parent().begin(), tree.parent().end());
+    string temp = path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if(!file)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(tree.posX().data(), sizeof(double), n, file) == size_t(n) &&
+              fwrite(tree.posY().data(), sizeof(double), n, file) == size_t(n) &&
+              fwrite(tree.cost().data(), sizeof(double), n, file) == size_t(n) &&
+              fwrite(parent.data(), sizeof(int32_t), n, file) == size_t(n);
+    ok = fclose(file) == 0 && ok;
+    if(!ok || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TreeSnapshot::fail(const std::string &error)
+{
+    close();
+    error_ = error;
+    return false;
+}
+
+/**
+* maps a snapshot file and checks that it is a well-formed tree: the
+* magic, version and size match and every node leads to node 0, the root
+* @return false with error() set if the file cannot be used
+*/
+bool TreeSnapshot::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return fail("cannot open " + path);
+    struct stat st;
+    if(fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Header))
+    {
+        ::close(fd);
+        return fail(path + " is too short for a tree snapshot");
+    }
+    bytes_ = st.st_size;
+    data_ = mmap(NULL, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(data_ == MAP_FAILED)
+    {
+        data_ = NULL;
+        return fail("cannot map " + path);
+    }
+
+    const Header* h = header();
+    if(memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0)
+        return fail(path + " is not a tree snapshot");
+    if(h->version != VERSION)
+        return fail(path + " has an unsupported snapshot version");
+    uint64_t n = h->nodeCount;
+    if(h->headerBytes < sizeof(Header) || h->headerBytes % 8 != 0 || n == 0 || n > 0x7fffffff ||
+       h->headerBytes + n * (3 * sizeof(double) + sizeof(int32_t)) > bytes_)
+        return fail(path + " is truncated or corrupt");
+
+    const char* base = (const char*)data_ + h->headerBytes;
+    size_ = n;
+    x_ = (const double*)base;
+    y_ = x_ + n;
+    cost_ = y_ + n;
+    parent_ = (const int32_t*)(cost_ + n);
+
+    //每个节点沿父节点都必须回到根节点0，否则是损坏的文件
+    vector<unsigned char> state(n, 0);
+    vector<int> chain;
+    state[0] = 2;
+    if(parent_[0] != 0)
+        return fail(path + " does not have node 0 as its root");
+    for(int i=1; i<size_; i++)
+    {
+        int node = i;
+        chain.clear();
+        while(state[node] == 0)
+        {
+            state[node] = 1;
+            chain.push_back(node);
+            int p = parent_[node];
+            if(p < 0 || p >= size_)
+                return fail(path + " has a parent out of range");
+            node = p;
+        }
+        if(state[node] == 1)
+            return fail(path + " has a cycle in its parent links");
+        for(int k=0; k<chain.size(); k++)
+            state[chain[k]] = 2;
+    }
+    error_.clear();
+    return true;
+}
+
+void TreeSnapshot::close()
+{
+    if(data_)
+        munmap(data_, bytes_);
+    data_ = NULL;
+    bytes_ = 0;
+    size_ = 0;
+    x_ = y_ = cost_ = NULL;
+    parent_ = NULL;
+}
+
+/**
+* copies the open snapshot into a tree
+* Parents may have larger ids than their children after rewiring, so every
+* node is added as a root first and linked afterwards.
+*/
+void TreeSnapshot::load(NodeStore &tree) const
+{
+    tree.clear();
+    for(int i=0; i<size_; i++)
+        tree.add(x_[i], y_[i], i, cost_[i]);
+    for(int i=1; i<size_; i++)
+        tree.setParent(i, parent_[i]);
+}
+
+}
@@ -0,0 +1,170 @@
+#include <rrt_star_planner/tree_visualizer.h>
+
+namespace rrtstar_planner{
+
+    using namespace std;
+
+TreeVisualizer::TreeVisualizer()
+    : running_(false), period_(0.5), maxEdges_(0), clearPending_(false), nextMarkerID_(0)
+{
+
+}
+
+TreeVisualizer::~TreeVisualizer()
+{
+    stop();
+}
+
+/**
+* advertises the marker topic once and starts the publisher thread
+* @param rate publishes per second
+* @param maxEdges edges per marker and type before a batch is decimated, 0 for no limit
+*/
+void TreeVisualizer::start(ros::NodeHandle &nh, const std::string &topic, double rate, int maxEdges)
+{
+    if(running_)
+        return;
+    publisher_ = nh.advertise<visualization_msgs::Marker>(topic, 1000);
+    period_ = 1.0 / rate;
+    maxEdges_ = maxEdges;
+    nextFlush_ = ros::WallTime::now();
+    running_ = true;
+    thread_ = boost::thread(&TreeVisualizer::run, this);
+}
+
+void TreeVisualizer::stop()
+{
+    if(!running_)
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+/**
+* sets frame, color and line width used for one type of edge
+*/
+void TreeVisualizer::setStyle(EdgeType type, const visualization_msgs::Marker &style)
+{
+    style_[type] = style;
+    style_[type].points.clear();
+}
+
+/**
+* drops the edges of the previous plan and clears the markers shown in RViz
+* The clear is queued ahead of everything the new plan hands over.
+*/
+void TreeVisualizer::beginPlan()
+{
+    for(int t=0; t<3; t++)
+        local_[t].clear();
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        for(int t=0; t<3; t++)
+            pending_[t].clear();
+        pendingMarkers_.clear();
+        clearPending_ = true;
+    }
+    wake_.notify_all();
+}
+
+void TreeVisualizer::addEdge(EdgeType type, double startX, double startY, double endX, double endY)
+{
+    geometry_msgs::Point point;
+    point.x = startX;
+    point.y = startY;
+    point.z = 0;
+    local_[type].push_back(point);
+    point.x = endX;
+    point.y = endY;
+    local_[type].push_back(point);
+}
+
+/**
+* hands the edges collected so far to the publisher thread, at most once per period
+* @param force hand them over regardless of the period, e.g. at the end of a plan
+*/
+void TreeVisualizer::flush(bool force)
+{
+    ros::WallTime now = ros::WallTime::now();
+    if(!force && now < nextFlush_)
+        return;
+    nextFlush_ = now + ros::WallDuration(period_);
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    for(int t=0; t<3; t++)
+    {
+        pending_[t].insert(pending_[t].end(), local_[t].begin(), local_[t].end());
+        local_[t].clear();
+    }
+}
+
+/**
+* publishes a single marker, e.g. the final path, as soon as the publisher
+* thread has sent the clear and the edges handed over before it
+*/
+void TreeVisualizer::publish(const visualization_msgs::Marker &marker)
+{
+    if(!running_)
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        pendingMarkers_.push_back(marker);
+    }
+    wake_.notify_all();
+}
+
+void TreeVisualizer::run()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while(running_)
+    {
+        //清除和单独的标记不等下一个周期，否则已经在排队时通知会丢失
+        if(!clearPending_ && pendingMarkers_.empty())
+            wake_.timed_wait(lock, boost::posix_time::microseconds(long(period_ * 1e6)));
+        bool clear = clearPending_;
+        clearPending_ = false;
+        for(int t=0; t<3; t++)
+        {
+            sending_[t].swap(pending_[t]);
+            pending_[t].clear();
+        }
+        sendingMarkers_.swap(pendingMarkers_);
+        pendingMarkers_.clear();
+        lock.unlock();
+
+        if(clear)
+        {
+            visualization_msgs::Marker deleteAll = style_[TREE_EDGE];
+            deleteAll.action = visualization_msgs::Marker::DELETEALL;
+            publisher_.publish(deleteAll);
+        }
+        for(int t=0; t<3; t++)
+        {
+            if(sending_[t].empty())
+                continue;
+            visualization_msgs::Marker marker = style_[t];
+            marker.header.stamp = ros::Time::now();
+            marker.id = 100 + nextMarkerID_++;
+            int edges = sending_[t].size() / 2;
+            int stride = (maxEdges_ > 0 && edges > maxEdges_) ? (edges + maxEdges_ - 1) / maxEdges_ : 1;
+            marker.points.reserve(2 * (edges / stride + 1));
+            for(int e=0; e<edges; e+=stride)
+            {
+                marker.points.push_back(sending_[t][2 * e]);
+                marker.points.push_back(sending_[t][2 * e + 1]);
+            }
+            publisher_.publish(marker);
+            sending_[t].clear();
+        }
+        for(int i=0; i<sendingMarkers_.size(); i++)
+            publisher_.publish(sendingMarkers_[i]);
+        sendingMarkers_.clear();
+
+        lock.lock();
+    }
+}
+
+}